@@ -0,0 +1,65 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../include/attention.hpp"
+
+TEST_CASE("Attention", "[!benchmark][attention]") {
+    const std::size_t dim = 64;
+    const auto scale = 1 / std::sqrt(static_cast<double>(dim));
+
+    for (const std::size_t len : {1024, 4096, 16384, 32768}) {
+        std::vector<double> q(len * dim);
+        for (std::size_t i = 0; i < q.size(); ++i) {
+            q[i] = static_cast<double>(i % 17) / 17 - 0.5;
+        }
+        const fun::matrix_view<const double> qv(q, len, dim);
+        std::vector<double> out(len * dim);
+        const fun::matrix_view<double> ov(out, len, dim);
+        const auto name = std::to_string(len);
+
+        // The score matrix alone takes 8 * len^2 bytes, 8 GiB at 32k, so the naive version stops
+        // at 8k.
+        if (len <= 8192) {
+            std::vector<double> scores(len * len);
+            BENCHMARK(name + " naive score matrix") {
+                for (std::size_t i = 0; i < len; ++i) {
+                    for (std::size_t j = 0; j < len; ++j) {
+                        auto dot = 0.0;
+                        for (std::size_t d = 0; d < dim; ++d) {
+                            dot += q[i * dim + d] * q[j * dim + d];
+                        }
+                        scores[i * len + j] = dot * scale;
+                    }
+                }
+                for (std::size_t i = 0; i < len; ++i) {
+                    const auto row = std::span<double>(scores).subspan(i * len, len);
+                    fun::softmax(row, row);
+                    for (std::size_t d = 0; d < dim; ++d) {
+                        out[i * dim + d] = 0;
+                    }
+                    for (std::size_t j = 0; j < len; ++j) {
+                        for (std::size_t d = 0; d < dim; ++d) {
+                            out[i * dim + d] += row[j] * q[j * dim + d];
+                        }
+                    }
+                }
+                return out.back();
+            };
+        }
+
+        BENCHMARK(name + " tiled") {
+            fun::attention(qv, qv, qv, ov, scale);
+            return out.back();
+        };
+
+        BENCHMARK(name + " tiled causal") {
+            fun::causal_attention(qv, qv, qv, ov, scale);
+            return out.back();
+        };
+    }
+}
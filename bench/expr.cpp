@@ -0,0 +1,38 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include "../include/batch.hpp"
+#include "../include/expr.hpp"
+
+TEST_CASE("Fused MLP epilogue", "[!benchmark][expr]") {
+    const std::size_t rows = 256;
+    const std::size_t cols = 4096;
+    std::vector<double> xs(rows * cols, 0.5);
+    std::vector<double> residual(rows * cols, 1.0);
+    std::vector<double> bias(cols, 0.25);
+    std::vector<double> out(xs.size());
+
+    BENCHMARK("separate passes") {
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            out[i] = xs[i] + bias[i % cols];
+        }
+        fun::batch::gelu(out, out);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            out[i] *= 0.5;
+        }
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            out[i] += residual[i];
+        }
+        return out.back();
+    };
+
+    BENCHMARK("fused expression") {
+        namespace ex = fun::expr;
+        ex::evaluate(ex::apply<fun::gelu<>>(ex::input(xs) + ex::bias(bias)) * 0.5 +
+                         ex::input(residual),
+                     out, cols);
+        return out.back();
+    };
+}
@@ -0,0 +1,31 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include "../include/batch.hpp"
+
+TEST_CASE("GELU formulations", "[!benchmark][gelu]") {
+    std::vector<double> zs(1 << 16);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        zs[i] = -8 + 16.0 * static_cast<double>(i) / static_cast<double>(zs.size());
+    }
+    std::vector<double> out(zs.size());
+
+    BENCHMARK("erf") {
+        fun::batch::gelu<fun::gelu_mode::erf>(zs, out);
+        return out.back();
+    };
+    BENCHMARK("tanh") {
+        fun::batch::gelu<fun::gelu_mode::tanh>(zs, out);
+        return out.back();
+    };
+    BENCHMARK("quick") {
+        fun::batch::gelu<fun::gelu_mode::quick>(zs, out);
+        return out.back();
+    };
+    BENCHMARK("erf only") {
+        fun::batch::erf(zs, out);
+        return out.back();
+    };
+}
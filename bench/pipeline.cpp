@@ -0,0 +1,35 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../include/pipeline.hpp"
+
+TEST_CASE("Runtime pipeline", "[!benchmark][pipeline]") {
+    const std::size_t cols = 4096;
+    const std::size_t size = cols * 1024;
+    std::vector<double> xs(size, 0.5);
+    std::vector<double> gate(size, 2.0);
+    std::vector<double> bias(cols, 0.25);
+    std::vector<double> out(size);
+
+    // SiLU is compute-bound, ReLU leaves the chain bound by memory traffic.
+    for (const auto act : {fun::activation::silu, fun::activation::relu}) {
+        fun::pipeline pipe;
+        pipe.add_bias(bias).activate(act).multiply(gate);
+        const auto name = act == fun::activation::silu ? std::string("SiLU") : std::string("ReLU");
+
+        BENCHMARK(name + " separate passes") {
+            fun::pipeline{}.add_bias(bias).run(xs, out, cols);
+            fun::batch::activate(act, out, out);
+            fun::pipeline{}.multiply(gate).run(out, out, cols);
+            return out.back();
+        };
+
+        BENCHMARK(name + " blocked pipeline") {
+            pipe.run(xs, out, cols);
+            return out.back();
+        };
+    }
+}
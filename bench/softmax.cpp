@@ -0,0 +1,71 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../include/parallel_softmax.hpp"
+#include "../include/softmax.hpp"
+
+TEST_CASE("Small-row softmax", "[!benchmark][softmax]") {
+    // Buffers are capped at 2^27 values, 1 GiB, so the wider rows stop short of 10M.
+    const std::size_t cap = std::size_t{1} << 27;
+    for (const std::size_t cols : {2, 4, 8, 16, 32, 64}) {
+        for (const std::size_t batch : {10'000, 1'000'000, 10'000'000}) {
+            if (batch * cols > cap) {
+                continue;
+            }
+            const auto rows = batch;
+            std::vector<double> zs(rows * cols);
+            for (std::size_t i = 0; i < zs.size(); ++i) {
+                zs[i] = static_cast<double>(i % 13) / 4 - 1.5;
+            }
+            std::vector<double> out(zs.size());
+            const fun::matrix_view<const double> in(zs, rows, cols);
+            const fun::matrix_view<double> res(out, rows, cols);
+            const auto name = std::to_string(cols) + " x " + std::to_string(rows);
+
+            BENCHMARK(name + " row by row") {
+                for (std::size_t i = 0; i < rows; ++i) {
+                    fun::softmax(in.row(i), res.row(i));
+                }
+                return out.back();
+            };
+
+            BENCHMARK(name + " lanes across rows") {
+                fun::softmax(in, res);
+                return out.back();
+            };
+        }
+    }
+}
+
+TEST_CASE("Wide-row softmax", "[!benchmark][softmax]") {
+    // Cost of -DENABLE_REPRODUCIBLE=ON, single thread, -O3 -march=native, two runs of 20-30
+    // samples on one core: 1M goes from 4.8-5.1 to 5.8-6.5 ms and 10M from 53-59 to 61-72 ms,
+    // about 15-25%. -ffp-contract=off alone costs as much; the pairwise tree adds one merge per
+    // parallel::GRAIN values and no measurable time.
+    for (const std::size_t cols : {100'000, 1'000'000, 10'000'000}) {
+        std::vector<double> zs(cols);
+        for (std::size_t j = 0; j < cols; ++j) {
+            zs[j] = static_cast<double>((j * 7919) % 1009) / 50 - 10;
+        }
+        std::vector<double> out(cols);
+        const auto name = std::to_string(cols);
+
+        BENCHMARK(name + " single thread") {
+            fun::softmax(zs, out);
+            return out.back();
+        };
+
+        BENCHMARK(name + " parallel fast") {
+            fun::parallel_softmax(zs, out, fun::reduction::fast);
+            return out.back();
+        };
+
+        BENCHMARK(name + " parallel deterministic") {
+            fun::parallel_softmax(zs, out, fun::reduction::deterministic);
+            return out.back();
+        };
+    }
+}
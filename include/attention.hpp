@@ -0,0 +1,184 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ATTENTION_HPP
+#define ATTENTION_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "constexpr_ops.hpp"
+#include "matrix.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+/**
+ * @brief Number of query rows sharing each key and value block loaded into cache.
+ */
+static const constexpr std::size_t ATTENTION_QUERY_TILE = 32;
+
+/**
+ * @brief Number of keys per block, the tile of scores then takes 16 KiB.
+ */
+static const constexpr std::size_t ATTENTION_KEY_BLOCK = 64;
+
+namespace detail {
+
+/**
+ * @brief Tiled attention with an optional causal horizon.
+ * @param q Queries.
+ * @param k Keys.
+ * @param v Values.
+ * @param out Output, also used as the accumulator of the weighted values.
+ * @param scale Factor applied to the scores.
+ * @param causal Whether query i only attends to the first i + offset + 1 keys.
+ * @param offset Number of keys preceding the first query.
+ */
+inline void tiled_attention(matrix_view<const double> q, matrix_view<const double> k,
+                            matrix_view<const double> v, matrix_view<double> out,
+                            const double scale, const bool causal, const std::size_t offset) {
+    const auto dim = q.cols;
+    std::array<double, ATTENTION_QUERY_TILE * ATTENTION_KEY_BLOCK> scores;
+    std::array<online_sum, ATTENTION_QUERY_TILE> state;
+    std::vector<double> keys(dim * ATTENTION_KEY_BLOCK);
+
+    for (std::size_t q0 = 0; q0 < q.rows; q0 += ATTENTION_QUERY_TILE) {
+        const auto tile = std::min(ATTENTION_QUERY_TILE, q.rows - q0);
+        const auto horizon = causal ? std::min(k.rows, q0 + tile + offset) : k.rows;
+        for (std::size_t r = 0; r < tile; ++r) {
+            const auto acc = out.row(q0 + r);
+            std::fill(acc.begin(), acc.end(), 0.0);
+            state[r] = online_sum{};
+        }
+
+        for (std::size_t k0 = 0; k0 < horizon; k0 += ATTENTION_KEY_BLOCK) {
+            const auto block = std::min(ATTENTION_KEY_BLOCK, horizon - k0);
+            // The transposed block turns every score row into contiguous multiply-adds.
+            for (std::size_t j = 0; j < block; ++j) {
+                const auto key = k.row(k0 + j);
+                for (std::size_t d = 0; d < dim; ++d) {
+                    keys[d * ATTENTION_KEY_BLOCK + j] = key[d];
+                }
+            }
+
+            for (std::size_t r = 0; r < tile; ++r) {
+                // Keys past the causal horizon of this row are left out of its block.
+                const auto limit = causal ? q0 + r + offset + 1 : k.rows;
+                const auto valid = limit > k0 ? std::min(block, limit - k0) : 0;
+                if (valid == 0) {
+                    continue;
+                }
+
+                const auto query = q.row(q0 + r);
+                const auto row = std::span<double>(scores).subspan(r * ATTENTION_KEY_BLOCK, valid);
+                std::fill(row.begin(), row.end(), 0.0);
+                for (std::size_t d = 0; d < dim; ++d) {
+                    const auto qd = query[d] * scale;
+                    const auto* kd = keys.data() + d * ATTENTION_KEY_BLOCK;
+                    for (std::size_t j = 0; j < valid; ++j) {
+                        row[j] += qd * kd[j];
+                    }
+                }
+
+                // Online softmax: rescale what was accumulated under the previous maximum.
+                auto& st = state[r];
+                const auto max = std::max(st.max, max_of(row));
+                const auto rescale = constexpr_ops::exp(st.max - max);
+                auto sum = 0.0;
+                for (auto& s : row) {
+                    s = constexpr_ops::exp(s - max);
+                    sum += s;
+                }
+                st.sum = st.sum * rescale + sum;
+                st.max = max;
+
+                const auto acc = out.row(q0 + r);
+                for (auto& a : acc) {
+                    a *= rescale;
+                }
+                for (std::size_t j = 0; j < valid; ++j) {
+                    const auto value = v.row(k0 + j);
+                    const auto p = row[j];
+                    for (std::size_t d = 0; d < acc.size(); ++d) {
+                        acc[d] += p * value[d];
+                    }
+                }
+            }
+        }
+
+        for (std::size_t r = 0; r < tile; ++r) {
+            const auto inv = state[r].sum == 0 ? 0.0 : 1 / state[r].sum;
+            for (auto& a : out.row(q0 + r)) {
+                a *= inv;
+            }
+        }
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Scaled dot-product attention softmax(scale * Q K^T) V without storing the scores.
+ *
+ * Queries are processed in tiles that stream over blocks of keys and values. Each query row
+ * keeps a running maximum and normalizer, rescales its accumulated output when a block raises
+ * the maximum, and adds the block's weighted values, so memory stays O(S) instead of O(S^2).
+ *
+ * @param q Queries, one row of dimension d per position.
+ * @param k Keys, one row of dimension d per position.
+ * @param v Values, one row per key.
+ * @param out Output, one row per query of the value dimension, must not alias the inputs.
+ * @param scale Factor applied to the scores, usually 1 / sqrt(d).
+ */
+inline void attention(matrix_view<const double> q, matrix_view<const double> k,
+                      matrix_view<const double> v, matrix_view<double> out, const double scale) {
+    detail::tiled_attention(q, k, v, out, scale, false, 0);
+}
+
+/**
+ * @brief Causal scaled dot-product attention without storing the scores.
+ *
+ * Query i attends to the first i + offset + 1 keys. Key blocks past the horizon of a whole
+ * query tile are never loaded, so the work is about half of the non-causal case.
+ *
+ * @param q Queries, one row of dimension d per position.
+ * @param k Keys, one row of dimension d per position.
+ * @param v Values, one row per key.
+ * @param out Output, one row per query of the value dimension, must not alias the inputs.
+ * @param scale Factor applied to the scores, usually 1 / sqrt(d).
+ * @param offset Number of keys preceding the first query, such as cached tokens when decoding.
+ */
+inline void causal_attention(matrix_view<const double> q, matrix_view<const double> k,
+                             matrix_view<const double> v, matrix_view<double> out,
+                             const double scale, const std::size_t offset = 0) {
+    detail::tiled_attention(q, k, v, out, scale, true, offset);
+}
+
+}  // namespace fun
+
+#endif  // ATTENTION_HPP
@@ -0,0 +1,284 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+#include "constexpr_ops.hpp"
+#include "fun.hpp"
+
+namespace fun::batch {
+
+/**
+ * @brief Number of elements the batched kernels inspect at a time when deciding whether a whole
+ * block can take a shortcut.
+ */
+static const constexpr std::size_t BLOCK_SIZE = 64;
+
+namespace detail {
+
+/**
+ * @brief Checks whether every value of a block is strictly greater than a bound.
+ * @param zs Input block.
+ * @param bound Lower bound.
+ * @return Whether the whole block lies above the bound.
+ */
+[[nodiscard]] constexpr auto all_above(std::span<const double> zs, const double bound) noexcept {
+    auto res = true;
+    for (const auto z : zs) {
+        res &= z > bound;
+    }
+    return res;
+}
+
+/**
+ * @brief Copies values, skipping the copy when computing in place.
+ * @param zs Input values.
+ * @param out Output values, same size as the input, may alias it.
+ */
+constexpr void copy(std::span<const double> zs, std::span<double> out) noexcept {
+    if (zs.data() != out.data()) {
+        std::copy(zs.begin(), zs.end(), out.begin());
+    }
+}
+
+/**
+ * @brief Applies an activation that is the identity above a threshold.
+ *
+ * Blocks lying entirely above the threshold are copied without evaluating the activation. Other
+ * blocks evaluate the activation everywhere and select the linear value branchlessly, so the
+ * loop body stays free of data-dependent control flow.
+ *
+ * @param zs Input values.
+ * @param out Output values, same size as the input, may alias it.
+ * @param threshold Input above which the activation is the identity.
+ * @param f Activation valid in the nonlinear regime.
+ */
+template <typename F>
+constexpr void linear_above(std::span<const double> zs, std::span<double> out,
+                            const double threshold, F f) noexcept {
+    for (std::size_t i = 0; i < zs.size(); i += BLOCK_SIZE) {
+        const auto block = zs.subspan(i, std::min(BLOCK_SIZE, zs.size() - i));
+        auto dst = out.subspan(i, block.size());
+        if (all_above(block, threshold)) {
+            copy(block, dst);
+            continue;
+        }
+        for (std::size_t j = 0; j < block.size(); ++j) {
+            const auto z = block[j];
+            const auto val = f(z);
+            dst[j] = z > threshold ? z : val;
+        }
+    }
+}
+
+/**
+ * @brief Applies a scalar function elementwise.
+ * @tparam F Scalar function.
+ * @param zs Input values.
+ * @param out Output values, same size as the input, may alias it.
+ * @param params Extra parameters passed after each input value.
+ */
+template <auto F, typename... Args>
+constexpr void map(std::span<const double> zs, std::span<double> out,
+                   const Args... params) noexcept {
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        out[i] = F(zs[i], params...);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Batched Softplus activation function.
+ * @param zs Input values.
+ * @param out Output values, same size as the input, may alias it.
+ */
+constexpr void softplus(std::span<const double> zs, std::span<double> out) noexcept {
+    detail::linear_above(zs, out, SOFTPLUS_THRESHOLD, [](const double z) {
+        return std::max(z, 0.0) + constexpr_ops::log1p(constexpr_ops::exp(-constexpr_ops::abs(z)));
+    });
+}
+
+/**
+ * @brief Batched Exponential Linear Units (ELU) activation function.
+ * @param zs Input values.
+ * @param out Output values, same size as the input, may alias it.
+ * @param a Scale parameter.
+ */
+constexpr void elu(std::span<const double> zs, std::span<double> out, const double a) noexcept {
+    detail::linear_above(zs, out, 0.0, [a](const double z) {
+        return a * constexpr_ops::expm1(std::min(z, 0.0));
+    });
+}
+
+/**
+ * @brief Batched Mish activation function.
+ * @param zs Input values.
+ * @param out Output values, same size as the input, may alias it.
+ */
+constexpr void mish(std::span<const double> zs, std::span<double> out) noexcept {
+    detail::linear_above(zs, out, SOFTPLUS_THRESHOLD, [](const double z) {
+        const auto expval = constexpr_ops::exp(z);
+        const auto n = expval * (expval + 2);
+        return z * n / (n + 2);
+    });
+}
+
+/**
+ * @brief Batched error function.
+ *
+ * Both the series used near zero and the erfc-based formula are evaluated and blended, so the
+ * loop has no data-dependent branches.
+ *
+ * @param xs Input values.
+ * @param out Output values, same size as the input, may alias it.
+ */
+constexpr void erf(std::span<const double> xs, std::span<double> out) noexcept {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        const auto x = xs[i];
+        const auto series = x * constexpr_ops::horner<constexpr_ops::detail::ERF_COEFFS>(x * x);
+        const auto tail = 1 - constexpr_ops::erfc(constexpr_ops::abs(x));
+        out[i] = constexpr_ops::abs(x) < 0.5 ? series : (x < 0 ? -tail : tail);
+    }
+}
+
+/**
+ * @brief Batched Gaussian Error Linear Unit (GELU) activation function.
+ * @tparam Mode Formulation of GELU, the tanh approximation by default.
+ * @param zs Input values.
+ * @param out Output values, same size as the input, may alias it.
+ */
+template <gelu_mode Mode = gelu_mode::tanh>
+constexpr void gelu(std::span<const double> zs, std::span<double> out) noexcept {
+    detail::map<fun::gelu<Mode>>(zs, out);
+}
+
+/**
+ * @brief Resolves a runtime activation selector into a scalar callable.
+ *
+ * The visitor is instantiated once per activation, so kernels written against the callable are
+ * compiled, inlined and vectorized for each of them while the selector is dispatched only once.
+ *
+ * @param kind Activation function.
+ * @param param Parameter of parametric activations, ignored by the others.
+ * @param visitor Callable invoked with a callable mapping a double to the activated double.
+ */
+template <typename V>
+constexpr void visit(const activation kind, const double param, V&& visitor) {
+    switch (kind) {
+        case activation::id:
+            visitor([](const double z) { return fun::id(z); });
+            break;
+        case activation::binary_step:
+            visitor([](const double z) { return static_cast<double>(fun::binary_step(z)); });
+            break;
+        case activation::sigmoid:
+            visitor([](const double z) { return fun::sigmoid(z); });
+            break;
+        case activation::relu:
+            visitor([](const double z) { return fun::relu(z); });
+            break;
+        case activation::leaky_relu:
+            visitor([](const double z) { return fun::leaky_relu(z); });
+            break;
+        case activation::parametric_relu:
+            visitor([param](const double z) { return fun::parametric_relu(z, param); });
+            break;
+        case activation::gelu_erf:
+            visitor([](const double z) { return fun::gelu<gelu_mode::erf>(z); });
+            break;
+        case activation::gelu_tanh:
+            visitor([](const double z) { return fun::gelu<gelu_mode::tanh>(z); });
+            break;
+        case activation::gelu_quick:
+            visitor([](const double z) { return fun::gelu<gelu_mode::quick>(z); });
+            break;
+        case activation::silu:
+            visitor([](const double z) { return fun::silu(z); });
+            break;
+        case activation::elu:
+            visitor([param](const double z) { return fun::elu(z, param); });
+            break;
+        case activation::softplus:
+            visitor([](const double z) { return fun::softplus(z); });
+            break;
+        case activation::mish:
+            visitor([](const double z) { return fun::mish(z); });
+            break;
+        case activation::tanh:
+            visitor([](const double z) { return fun::tanh(z); });
+            break;
+        case activation::gaussian:
+            visitor([](const double z) { return fun::gaussian(z); });
+            break;
+        case activation::gcs:
+            visitor([](const double z) { return fun::gcs(z); });
+            break;
+    }
+}
+
+/**
+ * @brief Batched activation selected at runtime.
+ *
+ * The selector is dispatched once per call rather than per element, so each case runs the same
+ * loop as the dedicated kernel.
+ *
+ * @param kind Activation function.
+ * @param zs Input values.
+ * @param out Output values, same size as the input, may alias it.
+ * @param param Parameter of parametric activations, ignored by the others.
+ */
+constexpr void activate(const activation kind, std::span<const double> zs, std::span<double> out,
+                        const double param = 0) noexcept {
+    switch (kind) {
+        case activation::id:
+            detail::copy(zs, out);
+            break;
+        case activation::elu:
+            elu(zs, out, param);
+            break;
+        case activation::softplus:
+            softplus(zs, out);
+            break;
+        case activation::mish:
+            mish(zs, out);
+            break;
+        default:
+            visit(kind, param, [&](const auto f) {
+                for (std::size_t i = 0; i < zs.size(); ++i) {
+                    out[i] = f(zs[i]);
+                }
+            });
+            break;
+    }
+}
+
+}  // namespace fun::batch
+
+#endif  // BATCH_HPP
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BLOCK_SPARSE_HPP
+#define BLOCK_SPARSE_HPP
+
+#include <cstddef>
+#include <span>
+
+#include "softmax.hpp"
+
+namespace fun {
+
+/**
+ * @brief Layout of a block-sparse matrix whose non-empty blocks are stored back to back.
+ *
+ * Row block i owns the stored blocks row_offsets[i] to row_offsets[i + 1] - 1, in the same
+ * compressed row format as CSR with blocks instead of elements, columns recording which column
+ * block each stored block is. Each stored block holds block * block values in row-major order.
+ */
+struct block_sparse_layout {
+    std::size_t block = 64;                    // Edge of a square block.
+    std::span<const std::size_t> row_offsets;  // First stored block of each row block, plus end.
+    std::span<const std::size_t> columns;      // Column block of each stored block.
+};
+
+/**
+ * @brief Softmax over the rows of a block-sparse score matrix, such as local-window or strided
+ * attention.
+ *
+ * Every row is normalized over the stored blocks of its row block only: the missing blocks are
+ * treated as zero probability and cost no work. Within a block each row segment is contiguous,
+ * so the reduction and normalization run as dense loops of the block width. The column indices
+ * are not read, since where a block sits along its row does not change its probabilities.
+ *
+ * @param blocks Stored blocks.
+ * @param out Output blocks in the same layout, may alias the input.
+ * @param layout Sparsity layout.
+ */
+constexpr void block_sparse_softmax(std::span<const double> blocks, std::span<double> out,
+                                    const block_sparse_layout& layout) noexcept {
+    const auto width = layout.block;
+    const auto area = width * width;
+    for (std::size_t i = 0; i + 1 < layout.row_offsets.size(); ++i) {
+        const auto first = layout.row_offsets[i];
+        const auto last = layout.row_offsets[i + 1];
+        for (std::size_t r = 0; r < width; ++r) {
+            detail::online_sum acc;
+            for (auto b = first; b < last; ++b) {
+                detail::accumulate(acc, blocks.subspan(b * area + r * width, width));
+            }
+            for (auto b = first; b < last; ++b) {
+                const auto offset = b * area + r * width;
+                detail::normalize(blocks.subspan(offset, width), out.subspan(offset, width), acc);
+            }
+        }
+    }
+}
+
+}  // namespace fun
+
+#endif  // BLOCK_SPARSE_HPP
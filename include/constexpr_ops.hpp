@@ -25,6 +25,12 @@
 #ifndef CONSTEXPR_OPS_HPP
 #define CONSTEXPR_OPS_HPP
 
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
 namespace constexpr_ops {
 
 /**
@@ -32,6 +38,45 @@ namespace constexpr_ops {
  */
 static const constexpr auto PI = 3.14159265358979323846264338327950288419716939937510;
 
+/**
+ * @brief Natural logarithm of 2.
+ */
+static const constexpr auto LN2 = 0.69314718055994530941723212145817656807550013436026;
+
+/**
+ * @brief Square root of 2.
+ */
+static const constexpr auto SQRT2 = 1.41421356237309504880168872420969807856967187537694;
+
+/**
+ * @brief Square root of 1/2.
+ */
+static const constexpr auto SQRT1_2 = 0.70710678118654752440084436210484903928483593768847;
+
+/**
+ * @brief 2 / sqrt(π), the scale of the error function.
+ */
+static const constexpr auto TWO_OVER_SQRTPI = 1.12837916709551257389615890312154517168810125865800;
+
+/**
+ * @brief Largest argument for which exp does not overflow.
+ */
+static const constexpr auto EXP_MAX = 709.782712893383973096;
+
+/**
+ * @brief Smallest argument for which exp does not underflow to zero.
+ */
+static const constexpr auto EXP_MIN = -745.133219101941108420;
+
+/**
+ * @brief Computes the absolute value of the given number.
+ * @param x Input value.
+ * @return The absolute value of the input value.
+ */
+[[nodiscard]] constexpr auto abs(const double x) noexcept {
+    return x < 0 ? -x : x;
+}
+
 /**
  * @brief Computes the power of the given number.
  * @param x Input value.
@@ -60,39 +105,520 @@ static const constexpr auto PI = 3.141592653589793238462643383279502884197169399
 }
 
 /**
- * @brief Uses the Taylor series expansion to compute the value of the exp function.
+ * @brief Computes the reciprocal of a factorial in floating point, which unlike factorial does
+ * not overflow for large arguments.
+ * @param num Input value.
+ * @return One over the factorial of the input value.
+ */
+[[nodiscard]] constexpr auto inverse_factorial(unsigned int num) noexcept {
+    auto res = 1.0;
+    for (; num > 1; --num) {
+        res /= num;
+    }
+    return res;
+}
+
+/**
+ * @brief Tabulates polynomial coefficients at compile time.
+ * @tparam N Number of coefficients.
+ * @param coeff Callable mapping a degree to its coefficient.
+ * @return Coefficients in increasing order of degree.
+ */
+template <std::size_t N, typename F>
+[[nodiscard]] consteval auto coefficients(F coeff) noexcept {
+    std::array<double, N> res{};
+    for (unsigned int n = 0; n < N; ++n) {
+        res[n] = coeff(n);
+    }
+    return res;
+}
+
+namespace detail {
+
+/**
+ * @brief Horner's scheme over the coefficients from index I onwards.
+ * @tparam Coeffs Coefficients in increasing order of degree.
+ * @tparam I Index of the first coefficient.
+ * @param x Input value.
+ * @return Value of the tail polynomial at the input value.
+ */
+template <const auto& Coeffs, std::size_t I>
+[[nodiscard]] constexpr double horner_tail(const double x) noexcept {
+    if constexpr (I + 1 == Coeffs.size()) {
+        return Coeffs[I];
+    } else {
+        return Coeffs[I] + x * horner_tail<Coeffs, I + 1>(x);
+    }
+}
+
+/**
+ * @brief Estrin's scheme over the N coefficients starting at index Lo.
+ * @tparam Coeffs Coefficients in increasing order of degree.
+ * @tparam Lo Index of the first coefficient.
+ * @tparam N Number of coefficients.
+ * @param powers Powers x, x^2, x^4, ... of the input value.
+ * @return Value of the partial polynomial at the input value.
+ */
+template <const auto& Coeffs, std::size_t Lo, std::size_t N, std::size_t L>
+[[nodiscard]] constexpr double estrin_range(const std::array<double, L>& powers) noexcept {
+    if constexpr (N == 1) {
+        return Coeffs[Lo];
+    } else {
+        constexpr auto level = std::bit_width(N - 1) - 1;
+        constexpr auto half = std::size_t{1} << level;
+        return estrin_range<Coeffs, Lo, half>(powers) +
+               powers[level] * estrin_range<Coeffs, Lo + half, N - half>(powers);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Evaluates a polynomial with Horner's scheme, which uses the fewest operations.
+ *
+ * The scheme is expanded at compile time into straight-line code, so callers inside loops remain
+ * vectorizable.
+ *
+ * @tparam Coeffs Coefficients in increasing order of degree.
+ * @param x Input value.
+ * @return Value of the polynomial at the input value.
+ */
+template <const auto& Coeffs>
+[[nodiscard]] constexpr auto horner(const double x) noexcept {
+    return detail::horner_tail<Coeffs, 0>(x);
+}
+
+/**
+ * @brief Evaluates a polynomial with Estrin's scheme.
+ *
+ * The coefficients are split recursively as p(x) = lo(x) + x^(2^k) hi(x), so the dependency chain
+ * has logarithmic rather than linear depth and independent multiply-adds can overlap.
+ *
+ * @tparam Coeffs Coefficients in increasing order of degree.
+ * @param x Input value.
+ * @return Value of the polynomial at the input value.
+ */
+template <const auto& Coeffs>
+[[nodiscard]] constexpr auto estrin(const double x) noexcept {
+    std::array<double, std::bit_width(Coeffs.size())> powers{x};
+    for (std::size_t i = 1; i < powers.size(); ++i) {
+        powers[i] = powers[i - 1] * powers[i - 1];
+    }
+    return detail::estrin_range<Coeffs, 0, Coeffs.size()>(powers);
+}
+
+namespace detail {
+
+/**
+ * @brief High part of ln(2) with trailing zero bits, so that k * LN2_HI is exact for |k| < 2^11.
+ */
+static const constexpr auto LN2_HI = 6.93147180369123816490e-01;
+
+/**
+ * @brief Low part of ln(2), LN2 - LN2_HI.
+ */
+static const constexpr auto LN2_LO = 1.90821492927058770002e-10;
+
+/**
+ * @brief High part of π / 2 with trailing zero bits, so that k * PIO2_HI is exact for |k| < 2^20.
+ */
+static const constexpr auto PIO2_HI = 1.57079632673412561417e+00;
+
+/**
+ * @brief Low part of π / 2, π / 2 - PIO2_HI.
+ */
+static const constexpr auto PIO2_LO = 6.07710050650619224932e-11;
+
+/**
+ * @brief Largest argument reduced with PIO2_HI and PIO2_LO, 2^20 π / 2.
+ */
+static const constexpr auto PIO2_MEDIUM = 0x1p20 * (PI / 2);
+
+/**
+ * @brief π / 2 as an unevaluated sum of three doubles, about 160 bits, for larger arguments.
+ */
+inline constexpr auto PIO2_PARTS = std::array<double, 3>{
+    1.57079632679489655800e+00, 6.12323399573676603587e-17, -1.49738490485916983294e-33};
+
+/**
+ * @brief Taylor coefficients of (exp(r) - 1) / r, i.e. 1 / (n + 1)!.
+ */
+inline constexpr auto EXPM1_COEFFS =
+    coefficients<13>([](const unsigned int n) { return inverse_factorial(n + 1); });
+
+/**
+ * @brief Series coefficients of atanh(s) / s in s^2, i.e. 1 / (2n + 1).
+ */
+inline constexpr auto ATANH_COEFFS =
+    coefficients<11>([](const unsigned int n) { return 1.0 / (2 * n + 1); });
+
+/**
+ * @brief Taylor coefficients of sin(r) / r in r^2, i.e. (-1)^n / (2n + 1)!.
+ */
+inline constexpr auto SIN_COEFFS = coefficients<9>(
+    [](const unsigned int n) { return (n % 2 == 0 ? 1 : -1) * inverse_factorial(2 * n + 1); });
+
+/**
+ * @brief Taylor coefficients of cos(r) in r^2, i.e. (-1)^n / (2n)!.
+ */
+inline constexpr auto COS_COEFFS = coefficients<10>(
+    [](const unsigned int n) { return (n % 2 == 0 ? 1 : -1) * inverse_factorial(2 * n); });
+
+/**
+ * @brief Taylor coefficients of erf(x) / x in x^2, i.e. 2 / sqrt(π) (-1)^n / (n! (2n + 1)).
+ */
+inline constexpr auto ERF_COEFFS = coefficients<13>([](const unsigned int n) {
+    return (n % 2 == 0 ? 1 : -1) * TWO_OVER_SQRTPI * inverse_factorial(n) / (2 * n + 1);
+});
+
+/**
+ * @brief Coefficients of P in erfc(z) = t exp(-z^2 + P(2t - 1)) with t = 2 / (2 + z), z >= 0.
+ *
+ * This is the Chebyshev interpolant of ln(exp(z^2) erfc(z) / t) at 24 nodes, converted to the
+ * monomial basis, with a relative error below 1e-14 for z < 6.
+ */
+inline constexpr auto ERFC_COEFFS = std::array<double, 24>{
+    -6.71794084056690499e-01, 6.72643223977656746e-01,  4.73433068413957533e-02,
+    -4.68956102311834516e-02, -9.87268934202371364e-03, 8.82493855731804333e-03,
+    1.75893309888507381e-03,  -2.34581250292063836e-03, -1.46242377978349209e-04,
+    6.73678789228675723e-04,  -9.37610392204278484e-05, -1.74302677741572891e-04,
+    7.14972934713224218e-05,  3.17430398912588592e-05,  -3.04248041962341335e-05,
+    1.46718925655735742e-07,  8.95714104315723482e-06,  -2.97125811785828773e-06,
+    -1.71619313482411822e-06, 1.28894146562951872e-06,  1.61150727701983294e-07,
+    -2.91814009310758284e-07, 5.45399623587453325e-10,  3.02018097182551303e-08,
+};
+
+/**
+ * @brief 1.5 * 2^52; adding it to |x| < 2^51 rounds x to an integer held in the low mantissa bits.
+ */
+static const constexpr auto ROUND_SHIFT = 0x1.8p52;
+
+/**
+ * @brief Computes 2^k by assembling the IEEE-754 bit pattern directly.
+ * @param k Exponent in the normal range [-1022, 1023].
+ * @return 2 raised to the given exponent.
+ */
+[[nodiscard]] constexpr auto exp2i(const std::int64_t k) noexcept {
+    return std::bit_cast<double>(static_cast<std::uint64_t>(k + 1023) << 52);
+}
+
+/**
+ * @brief Rounds to the nearest integer, halfway cases away from zero.
+ * @param x Input value.
+ * @return The nearest integer.
+ */
+[[nodiscard]] constexpr auto round(const double x) noexcept {
+    return static_cast<std::int64_t>(x < 0 ? x - 0.5 : x + 0.5);
+}
+
+/**
+ * @brief Computes exp(r) - 1 for the reduced argument |r| <= ln(2) / 2.
+ *
+ * This is the innermost kernel of every exponential in the library, so it uses Estrin's scheme
+ * to shorten the dependency chain.
+ *
+ * @param r Reduced input value.
+ * @return exp(r) - 1 without cancellation.
+ */
+[[nodiscard]] constexpr auto expm1_kernel(const double r) noexcept {
+    return r * estrin<EXPM1_COEFFS>(r);
+}
+
+/**
+ * @brief Computes ln(m) = 2 atanh((m - 1) / (m + 1)) for m in [1 / sqrt(2), sqrt(2)].
+ * @param s Transformed input value (m - 1) / (m + 1).
+ * @return ln(m).
+ */
+[[nodiscard]] constexpr auto log_kernel(const double s) noexcept {
+    return 2 * s * horner<ATANH_COEFFS>(s * s);
+}
+
+/**
+ * @brief Computes sin(r) for the reduced argument |r| <= π / 4.
+ * @param r Reduced input value.
+ * @return sin of the reduced input value.
+ */
+[[nodiscard]] constexpr auto sin_kernel(const double r) noexcept {
+    return r * horner<SIN_COEFFS>(r * r);
+}
+
+/**
+ * @brief Computes cos(r) for the reduced argument |r| <= π / 4.
+ * @param r Reduced input value.
+ * @return cos of the reduced input value.
+ */
+[[nodiscard]] constexpr auto cos_kernel(const double r) noexcept {
+    return horner<COS_COEFFS>(r * r);
+}
+
+/**
+ * @brief Splits a value into three parts of at most 18 significant bits, so that the product of
+ * any two parts is exact.
+ *
+ * The parts are cut by clearing trailing mantissa bits rather than by Veltkamp's multiplication,
+ * which contraction into FMA would break.
+ *
+ * @param x Input value.
+ * @return Parts summing to x, largest first.
+ */
+[[nodiscard]] constexpr auto split3(const double x) noexcept {
+    std::array<double, 3> res{};
+    auto rest = x;
+    for (auto& part : res) {
+        part = std::bit_cast<double>(std::bit_cast<std::uint64_t>(rest) & ~std::uint64_t{0} << 35);
+        rest -= part;
+    }
+    return res;
+}
+
+/**
+ * @brief Adds a value to the double-double hi + lo, keeping the rounding error of hi in lo.
+ * @param hi High word, renormalized so that |lo| stays below half an ulp of it.
+ * @param lo Low word.
+ * @param x Value to add.
+ */
+constexpr void add_exact(double& hi, double& lo, const double x) noexcept {
+    const auto sum = hi + x;
+    const auto b = sum - hi;
+    lo += (hi - (sum - b)) + (x - b);
+    hi = sum + lo;
+    lo -= hi - sum;
+}
+
+/**
+ * @brief Subtracts k π / 2 from the double-double hi + lo, with every partial product exact.
+ * @param hi High word.
+ * @param lo Low word.
+ * @param k Integer multiple.
+ */
+constexpr void sub_pio2(double& hi, double& lo, const double k) noexcept {
+    const auto ks = split3(k);
+    for (const auto part : PIO2_PARTS) {
+        for (const auto p : split3(part)) {
+            for (const auto kp : ks) {
+                add_exact(hi, lo, -(kp * p));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Reduces an argument modulo π / 2.
+ *
+ * Up to PIO2_MEDIUM the two-part constant is exact enough (Cody and Waite). Beyond it, x - k π / 2
+ * is computed in double-double arithmetic against PIO2_PARTS; the quotient is then only rounded
+ * to within a few hundred units, so a second pass takes off the multiples of π / 2 left over.
+ *
+ * @param x Input value with |x| < 2^62.
+ * @param r Reduced input value with |r| <= π / 4.
+ * @return The quadrant x lies in, modulo 4.
+ */
+[[nodiscard]] constexpr auto reduce_pio2(const double x, double& r) noexcept {
+    const auto k = round(x / (PI / 2));
+    if (abs(x) < PIO2_MEDIUM) {
+        r = (x - k * PIO2_HI) - k * PIO2_LO;
+        return k & 3;
+    }
+    auto hi = x;
+    auto lo = 0.0;
+    sub_pio2(hi, lo, static_cast<double>(k));
+    const auto rest = round(hi / (PI / 2));
+    sub_pio2(hi, lo, static_cast<double>(rest));
+    r = hi + lo;
+    return (k + rest) & 3;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Computes the value of the exp function.
+ *
+ * The argument is reduced to x = k ln(2) + r with |r| <= ln(2) / 2, so that the Taylor series
+ * only ever sees small arguments and the result is scaled back by 2^k.
+ *
  * @param x Input value.
  * @return exp of the input value.
  */
 [[nodiscard]] constexpr auto exp(const double x) noexcept {
-    return 1 + x + pow(x, 2) / factorial(2) + pow(x, 3) / factorial(3) + pow(x, 4) / factorial(4) +
-           pow(x, 5) / factorial(5) + pow(x, 6) / factorial(6) + pow(x, 7) / factorial(7) +
-           pow(x, 8) / factorial(8) + pow(x, 9) / factorial(9) + pow(x, 10) / factorial(10) +
-           pow(x, 11) / factorial(11) + pow(x, 12) / factorial(12);
+    // Clamping still overflows to infinity past EXP_MAX and underflows to zero past EXP_MIN,
+    // while NaN fails both comparisons and propagates, so the function needs no branches.
+    const auto xc = x > 710 ? 710.0 : (x < -746 ? -746.0 : x);
+    const auto shifted = xc * (1 / LN2) + detail::ROUND_SHIFT;
+    const auto kd = shifted - detail::ROUND_SHIFT;
+    const auto k = static_cast<std::int64_t>(std::bit_cast<std::uint64_t>(shifted) -
+                                             std::bit_cast<std::uint64_t>(detail::ROUND_SHIFT));
+    const auto r = (xc - kd * detail::LN2_HI) - kd * detail::LN2_LO;
+    const auto half = k / 2;
+    return (1 + detail::expm1_kernel(r)) * detail::exp2i(half) * detail::exp2i(k - half);
+}
+
+/**
+ * @brief Computes exp(x) - 1 without the cancellation of the naive formula near zero.
+ * @param x Input value.
+ * @return exp of the input value minus one.
+ */
+[[nodiscard]] constexpr auto expm1(const double x) noexcept {
+    if (x != x) {
+        return x;
+    }
+    if (abs(x) <= LN2 / 2) {
+        return detail::expm1_kernel(x);
+    }
+    if (x > 38) {
+        return exp(x);
+    }
+    if (x < -38) {
+        return -1.0;
+    }
+    const auto k = detail::round(x / LN2);
+    const auto r = (x - k * detail::LN2_HI) - k * detail::LN2_LO;
+    const auto scale = detail::exp2i(k);
+    return scale * detail::expm1_kernel(r) + (scale - 1);
+}
+
+/**
+ * @brief Computes ln(1 + x) without losing the low-order bits of small inputs.
+ * @param x Input value.
+ * @return Natural logarithm of one plus the input value.
+ */
+[[nodiscard]] constexpr auto log1p(const double x) noexcept {
+    if (x != x || x == std::numeric_limits<double>::infinity()) {
+        return x;
+    }
+    if (x < -1) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (x == -1) {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    const auto u = 1 + x;
+    const auto bits = std::bit_cast<std::uint64_t>(u);
+    auto k = static_cast<std::int64_t>((bits >> 52) & 0x7ff) - 1023;
+    auto m = std::bit_cast<double>((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    if (m > SQRT2) {
+        m /= 2;
+        ++k;
+    }
+    if (k == 0) {
+        return detail::log_kernel(x / (2 + x));
+    }
+
+    // The rounding error of 1 + x, divided by u, restores the bits lost when forming u.
+    const auto c = (k > 0 ? 1 - (u - x) : x - (u - 1)) / u;
+    return k * detail::LN2_HI + (detail::log_kernel((m - 1) / (m + 1)) + (c + k * detail::LN2_LO));
+}
+
+/**
+ * @brief Computes the natural logarithm to full precision, subnormal inputs included.
+ * @param x Input value.
+ * @return Natural logarithm of the input value.
+ */
+[[nodiscard]] constexpr auto log(double x) noexcept {
+    if (x != x || x < 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (x == 0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    if (x == std::numeric_limits<double>::infinity()) {
+        return x;
+    }
+
+    std::int64_t k = 0;
+    if (x < std::numeric_limits<double>::min()) {
+        x *= 0x1p54;
+        k = -54;
+    }
+    const auto bits = std::bit_cast<std::uint64_t>(x);
+    k += static_cast<std::int64_t>((bits >> 52) & 0x7ff) - 1023;
+    auto m = std::bit_cast<double>((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    if (m > SQRT2) {
+        m /= 2;
+        ++k;
+    }
+    return k * detail::LN2_HI + (detail::log_kernel((m - 1) / (m + 1)) + k * detail::LN2_LO);
+}
+
+/**
+ * @brief Computes the complementary error function erfc(x) = 1 - erf(x).
+ *
+ * A single branch-free formula covers the whole real line, so the function vectorizes, and the
+ * result keeps full relative precision in the tail where erf(x) rounds to one.
+ *
+ * @param x Input value.
+ * @return erfc of the input value.
+ */
+[[nodiscard]] constexpr auto erfc(const double x) noexcept {
+    const auto z = abs(x);
+    const auto t = 2 / (2 + z);
+    const auto res = t * exp(-z * z + estrin<detail::ERFC_COEFFS>(2 * t - 1));
+    return x < 0 ? 2 - res : res;
 }
 
 /**
- * @brief Uses the Taylor series expansion to compute the value of the sin function.
+ * @brief Computes the error function erf(x) = 2 / sqrt(π) ∫_0^x exp(-t^2) dt.
  * @param x Input value.
+ * @return erf of the input value.
+ */
+[[nodiscard]] constexpr auto erf(const double x) noexcept {
+    if (abs(x) < 0.5) {
+        return x * horner<detail::ERF_COEFFS>(x * x);
+    }
+    const auto res = 1 - erfc(abs(x));
+    return x < 0 ? -res : res;
+}
+
+/**
+ * @brief Computes the value of the sin function.
+ *
+ * The argument is reduced modulo π / 2 and the Taylor series of sin or cos is evaluated on the
+ * remainder, depending on the quadrant.
+ *
+ * @param x Input value with |x| < 2^62.
  * @return sin of the input value.
  */
 [[nodiscard]] constexpr auto sin(const double x) noexcept {
-    return x - pow(x, 3) / factorial(3) + pow(x, 5) / factorial(5) - pow(x, 7) / factorial(7) +
-           pow(x, 9) / factorial(9) - pow(x, 11) / factorial(11) + pow(x, 13) / factorial(13);
+    if (!(abs(x) < 0x1p62)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    auto r = 0.0;
+    switch (detail::reduce_pio2(x, r)) {
+        case 0:
+            return detail::sin_kernel(r);
+        case 1:
+            return detail::cos_kernel(r);
+        case 2:
+            return -detail::sin_kernel(r);
+        default:
+            return -detail::cos_kernel(r);
+    }
 }
 
 /**
- * @brief Uses the Taylor series expansion to compute the value of the cos function.
- * @param x Input value.
+ * @brief Computes the value of the cos function.
+ * @param x Input value with |x| < 2^62.
  * @return cos of the input value.
  */
 [[nodiscard]] constexpr auto cos(const double x) noexcept {
-    return 1 - pow(x, 2) / factorial(2) + pow(x, 4) / factorial(4) - pow(x, 6) / factorial(6) +
-           pow(x, 8) / factorial(8) - pow(x, 10) / factorial(10) + pow(x, 12) / factorial(12);
+    if (!(abs(x) < 0x1p62)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    auto r = 0.0;
+    switch (detail::reduce_pio2(x, r)) {
+        case 0:
+            return detail::cos_kernel(r);
+        case 1:
+            return -detail::sin_kernel(r);
+        case 2:
+            return -detail::cos_kernel(r);
+        default:
+            return detail::sin_kernel(r);
+    }
 }
 
 /**
- * @brief Uses the Taylor series expansion for computing the value of the cosh function.
+ * @brief Computes the value of the cosh function.
  * @param x Input value.
  * @return cosh of the input value.
  */
@@ -101,12 +627,15 @@ static const constexpr auto PI = 3.141592653589793238462643383279502884197169399
 }
 
 /**
- * @brief Uses the Taylor series expansion for computing the value of the tanh function.
+ * @brief Computes the value of the tanh function via expm1, which neither overflows for large
+ * inputs nor cancels for small ones.
  * @param x Input value.
  * @return tanh of the input value.
  */
 [[nodiscard]] constexpr auto tanh(const double x) noexcept {
-    return (exp(x) - exp(-x)) / (exp(x) + exp(-x));
+    const auto t = expm1(-2 * abs(x));
+    const auto res = -t / (2 + t);
+    return x < 0 ? -res : res;
 }
 
 /**
@@ -129,9 +658,11 @@ static const constexpr auto PI = 3.141592653589793238462643383279502884197169399
  * @return The natural logarithm of the input value.
  */
 [[nodiscard]] constexpr auto ln(double x, double epsilon = 1e-5) noexcept {
-    double y = x - 1.0;
-    double z = y;
-    auto abs = [](const auto a) { return a < 0 ? -a : a; };
+    // Start from the binary exponent so that exp(y) stays finite for large inputs.
+    const auto bits = std::bit_cast<std::uint64_t>(x);
+    const auto k = static_cast<std::int64_t>((bits >> 52) & 0x7ff) - 1023;
+    double y = 0.0;
+    double z = k * LN2;
 
     do {
         y = z;
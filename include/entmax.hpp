@@ -0,0 +1,340 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ENTMAX_HPP
+#define ENTMAX_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "constexpr_ops.hpp"
+#include "matrix.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+namespace detail {
+
+/**
+ * @brief Maximum number of threshold refinements, enough to bisect the initial unit interval down
+ * to the spacing of doubles.
+ */
+static const constexpr int THRESHOLD_STEPS = 64;
+
+/**
+ * @brief Square root accurate over the whole range of probabilities.
+ *
+ * Halving the exponent bits gives a seed within 6%, so a few Newton steps reach full precision
+ * even for tiny inputs, where constexpr_ops::sqrt starting from the input would not.
+ *
+ * @param x Input value.
+ * @return The square root of the input, zero when it is not positive.
+ */
+[[nodiscard]] constexpr auto root(const double x) noexcept {
+    if (!(x > 0)) {
+        return 0.0;
+    }
+    auto res = std::bit_cast<double>((std::bit_cast<std::uint64_t>(x) >> 1) + 0x1ff8000000000000);
+    for (int i = 0; i < 5; ++i) {
+        res = 0.5 * (res + x / res);
+    }
+    return res;
+}
+
+/**
+ * @brief Count, sum and sum of squares of the values above a candidate threshold.
+ */
+struct support_stats {
+    double count = 0;
+    double sum = 0;
+    double squares = 0;
+};
+
+/**
+ * @brief Gathers the support statistics of scale * z - shift above a threshold in one pass.
+ *
+ * The pass is branch-free and keeps one accumulator per SIMD lane, so it vectorizes without
+ * reassociating a single sum.
+ *
+ * @param zs Input values.
+ * @param scale Factor applied to the values.
+ * @param shift Offset subtracted from the scaled values.
+ * @param tau Candidate threshold.
+ * @return Statistics of the values above the threshold.
+ */
+[[nodiscard]] constexpr auto gather(std::span<const double> zs, const double scale,
+                                    const double shift, const double tau) noexcept {
+    std::array<double, SOFTMAX_LANES> count{};
+    std::array<double, SOFTMAX_LANES> sum{};
+    std::array<double, SOFTMAX_LANES> squares{};
+
+    const auto step = [&](const std::size_t l, const double z) {
+        const auto x = scale * z - shift;
+        const auto v = x > tau ? x : 0.0;
+        count[l] += x > tau ? 1.0 : 0.0;
+        sum[l] += v;
+        squares[l] += v * v;
+    };
+    const auto body = zs.size() - zs.size() % SOFTMAX_LANES;
+    for (std::size_t j = 0; j < body; j += SOFTMAX_LANES) {
+        for (std::size_t l = 0; l < SOFTMAX_LANES; ++l) {
+            step(l, zs[j + l]);
+        }
+    }
+    for (auto j = body; j < zs.size(); ++j) {
+        step(0, zs[j]);
+    }
+
+    support_stats res;
+    for (std::size_t l = 0; l < SOFTMAX_LANES; ++l) {
+        res.count += count[l];
+        res.sum += sum[l];
+        res.squares += squares[l];
+    }
+    return res;
+}
+
+/**
+ * @brief Finds the threshold of sparsemax or 1.5-entmax.
+ *
+ * Every pass solves for the threshold in closed form over the support it found, and the next
+ * pass is evaluated there; once the support no longer changes, that solution is exact. A
+ * bisection bracket catches candidates that do not make progress. Starting from a superset of
+ * the support, as the sort-free Michelot algorithm does, typical rows take a handful of linear
+ * passes.
+ *
+ * @tparam Entmax Whether to solve sum((z / 2 - tau)_+^2) = 1 instead of sum((z - tau)_+) = 1.
+ * @param zs Input values, not empty.
+ * @param shift Largest scaled value, subtracted so that the closed forms see values in [-1, 0].
+ * @return The threshold tau on the scaled and shifted values.
+ */
+template <bool Entmax>
+[[nodiscard]] constexpr auto threshold(std::span<const double> zs, const double shift) noexcept {
+    const auto scale = Entmax ? 0.5 : 1.0;
+    // The largest value alone reaches the unit mass at -1, and nothing at 0.
+    auto lo = -1.0;
+    auto hi = 0.0;
+    auto tau = lo;
+    auto support = -1.0;
+    for (int i = 0; i < THRESHOLD_STEPS; ++i) {
+        const auto st = gather(zs, scale, shift, tau);
+        if (st.count == support) {
+            return tau;
+        }
+        auto excess = st.sum - st.count * tau - 1;
+        auto next = (st.sum - 1) / st.count;
+        if constexpr (Entmax) {
+            const auto mean = st.sum / st.count;
+            excess = st.squares - 2 * tau * st.sum + st.count * tau * tau - 1;
+            next = mean - root((1 - (st.squares - st.sum * mean)) / st.count);
+        }
+        (excess >= 0 ? lo : hi) = tau;
+        support = st.count;
+        tau = next >= lo && next < hi ? next : lo + (hi - lo) / 2;
+    }
+    return lo;
+}
+
+/**
+ * @brief Evaluates sparsemax or 1.5-entmax at one value.
+ * @tparam Entmax Whether to evaluate 1.5-entmax.
+ * @param z Input value.
+ * @param shift Largest scaled value.
+ * @param tau Threshold on the scaled and shifted values.
+ * @return Probability of the value.
+ */
+template <bool Entmax>
+[[nodiscard]] constexpr auto sparse_probability(const double z, const double shift,
+                                                const double tau) noexcept {
+    const auto x = (Entmax ? 0.5 * z : z) - shift - tau;
+    const auto p = x > 0 ? x : 0.0;
+    return Entmax ? p * p : p;
+}
+
+/**
+ * @brief Dense sparsemax or 1.5-entmax over one row.
+ * @tparam Entmax Whether to evaluate 1.5-entmax.
+ * @param zs Input values.
+ * @param out Output values, may alias the input.
+ */
+template <bool Entmax>
+constexpr void sparse_dense(std::span<const double> zs, std::span<double> out) noexcept {
+    if (zs.empty()) {
+        return;
+    }
+    const auto shift = (Entmax ? 0.5 : 1.0) * max_of(zs);
+    const auto tau = threshold<Entmax>(zs, shift);
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        out[j] = sparse_probability<Entmax>(zs[j], shift, tau);
+    }
+}
+
+/**
+ * @brief Compact sparsemax or 1.5-entmax over one row.
+ * @tparam Entmax Whether to evaluate 1.5-entmax.
+ * @param zs Input values.
+ * @param indices Positions of the non-zero probabilities, room for as many as the input.
+ * @param values Non-zero probabilities, room for as many as the input.
+ * @return Number of non-zero probabilities.
+ */
+template <bool Entmax>
+constexpr auto sparse_compact(std::span<const double> zs, std::span<std::size_t> indices,
+                              std::span<double> values) noexcept {
+    std::size_t count = 0;
+    if (zs.empty()) {
+        return count;
+    }
+    const auto shift = (Entmax ? 0.5 : 1.0) * max_of(zs);
+    const auto tau = threshold<Entmax>(zs, shift);
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        const auto p = sparse_probability<Entmax>(zs[j], shift, tau);
+        indices[count] = j;
+        values[count] = p;
+        count += p > 0 ? 1 : 0;
+    }
+    return count;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Sparsemax, the Euclidean projection of the input onto the probability simplex.
+ *
+ * Unlike softmax, every value below a threshold gets exactly zero probability. The threshold is
+ * found with linear passes instead of the O(n log n) sort of the reference algorithm.
+ *
+ * @param zs Input values.
+ * @param out Output values, may alias the input.
+ */
+constexpr void sparsemax(std::span<const double> zs, std::span<double> out) noexcept {
+    detail::sparse_dense<false>(zs, out);
+}
+
+/**
+ * @brief Sparsemax returning only the non-zero probabilities.
+ * @param zs Input values.
+ * @param indices Positions of the non-zero probabilities, room for as many as the input.
+ * @param values Non-zero probabilities, room for as many as the input.
+ * @return Number of non-zero probabilities.
+ */
+constexpr auto sparsemax(std::span<const double> zs, std::span<std::size_t> indices,
+                         std::span<double> values) noexcept {
+    return detail::sparse_compact<false>(zs, indices, values);
+}
+
+/**
+ * @brief Sparsemax over every row of a matrix.
+ * @param in Input rows.
+ * @param out Output rows of the same shape, may alias the input.
+ */
+constexpr void sparsemax(matrix_view<const double> in, matrix_view<double> out) noexcept {
+    for (std::size_t i = 0; i < in.rows; ++i) {
+        detail::sparse_dense<false>(in.row(i), out.row(i));
+    }
+}
+
+/**
+ * @brief Backward pass of sparsemax.
+ * @param probs Output of the forward pass.
+ * @param grad Gradient with respect to the output.
+ * @param grad_in Gradient with respect to the input, may alias grad.
+ */
+constexpr void sparsemax_backward(std::span<const double> probs, std::span<const double> grad,
+                                  std::span<double> grad_in) noexcept {
+    auto count = 0.0;
+    auto sum = 0.0;
+    for (std::size_t j = 0; j < probs.size(); ++j) {
+        count += probs[j] > 0 ? 1.0 : 0.0;
+        sum += probs[j] > 0 ? grad[j] : 0.0;
+    }
+    const auto mean = count == 0 ? 0.0 : sum / count;
+    for (std::size_t j = 0; j < probs.size(); ++j) {
+        grad_in[j] = probs[j] > 0 ? grad[j] - mean : 0.0;
+    }
+}
+
+/**
+ * @brief 1.5-entmax, p = (z / 2 - tau)_+^2, between softmax and sparsemax in sparsity.
+ * @param zs Input values.
+ * @param out Output values, may alias the input.
+ */
+constexpr void entmax15(std::span<const double> zs, std::span<double> out) noexcept {
+    detail::sparse_dense<true>(zs, out);
+}
+
+/**
+ * @brief 1.5-entmax returning only the non-zero probabilities.
+ * @param zs Input values.
+ * @param indices Positions of the non-zero probabilities, room for as many as the input.
+ * @param values Non-zero probabilities, room for as many as the input.
+ * @return Number of non-zero probabilities.
+ */
+constexpr auto entmax15(std::span<const double> zs, std::span<std::size_t> indices,
+                        std::span<double> values) noexcept {
+    return detail::sparse_compact<true>(zs, indices, values);
+}
+
+/**
+ * @brief 1.5-entmax over every row of a matrix.
+ * @param in Input rows.
+ * @param out Output rows of the same shape, may alias the input.
+ */
+constexpr void entmax15(matrix_view<const double> in, matrix_view<double> out) noexcept {
+    for (std::size_t i = 0; i < in.rows; ++i) {
+        detail::sparse_dense<true>(in.row(i), out.row(i));
+    }
+}
+
+/**
+ * @brief Backward pass of 1.5-entmax.
+ *
+ * With q = sqrt(p), the Jacobian is diag(q) - q q^T / sum(q), so the input gradient is
+ * q * g - q * sum(q * g) / sum(q).
+ *
+ * @param probs Output of the forward pass.
+ * @param grad Gradient with respect to the output.
+ * @param grad_in Gradient with respect to the input, may alias grad.
+ */
+constexpr void entmax15_backward(std::span<const double> probs, std::span<const double> grad,
+                                 std::span<double> grad_in) noexcept {
+    auto norm = 0.0;
+    auto dot = 0.0;
+    for (std::size_t j = 0; j < probs.size(); ++j) {
+        const auto q = detail::root(probs[j]);
+        norm += q;
+        dot += q * grad[j];
+    }
+    const auto mean = norm == 0 ? 0.0 : dot / norm;
+    for (std::size_t j = 0; j < probs.size(); ++j) {
+        grad_in[j] = detail::root(probs[j]) * (grad[j] - mean);
+    }
+}
+
+}  // namespace fun
+
+#endif  // ENTMAX_HPP
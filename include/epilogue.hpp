@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EPILOGUE_HPP
+#define EPILOGUE_HPP
+
+#include <cstddef>
+#include <span>
+
+#include "batch.hpp"
+#include "fun.hpp"
+#include "matrix.hpp"
+
+namespace fun {
+
+/**
+ * @brief Adds a per-column bias to a dense layer output and activates it in one pass.
+ *
+ * Each element is loaded once, has its bias added and its activation applied in registers, and is
+ * stored once, instead of a bias pass followed by an activation pass.
+ *
+ * @param in Pre-activation matrix.
+ * @param bias Values, one per column, broadcast across rows.
+ * @param out Output matrix of the same shape, may alias the input.
+ * @param kind Activation function.
+ * @param param Parameter of parametric activations, ignored by the others.
+ */
+inline void bias_activate(matrix_view<const double> in, std::span<const double> bias,
+                          matrix_view<double> out, const activation kind,
+                          const double param = 0) noexcept {
+    batch::visit(kind, param, [&](const auto f) {
+        for (std::size_t i = 0; i < in.rows; ++i) {
+            const auto src = in.row(i);
+            const auto dst = out.row(i);
+            for (std::size_t j = 0; j < src.size(); ++j) {
+                dst[j] = f(src[j] + bias[j]);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Adds a per-column bias to a dense layer output and activates it in place.
+ * @param inout Pre-activation matrix, overwritten with the activated values.
+ * @param bias Values, one per column, broadcast across rows.
+ * @param kind Activation function.
+ * @param param Parameter of parametric activations, ignored by the others.
+ */
+inline void bias_activate(matrix_view<double> inout, std::span<const double> bias,
+                          const activation kind, const double param = 0) noexcept {
+    bias_activate(inout, bias, inout, kind, param);
+}
+
+}  // namespace fun
+
+#endif  // EPILOGUE_HPP
@@ -0,0 +1,260 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EXPR_HPP
+#define EXPR_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace fun::expr {
+
+/**
+ * @brief Requirement satisfied by expression nodes.
+ *
+ * A node is evaluated at a flat element index i and at the column index of that element, which
+ * lets per-column operands such as biases broadcast across the rows of a row-major matrix.
+ */
+template <typename E>
+concept expression = requires(const E& e, std::size_t i) {
+    typename E::expression_tag;
+    { e(i, i) } -> std::convertible_to<double>;
+};
+
+/**
+ * @brief Leaf reading one value per element, e.g. the layer input or a residual.
+ */
+struct tensor {
+    using expression_tag = void;
+
+    std::span<const double> data;
+
+    [[nodiscard]] constexpr auto operator()(const std::size_t i,
+                                            [[maybe_unused]] const std::size_t col) const noexcept {
+        return data[i];
+    }
+};
+
+/**
+ * @brief Leaf reading one value per column, broadcast across rows.
+ */
+struct broadcast {
+    using expression_tag = void;
+
+    std::span<const double> data;
+
+    [[nodiscard]] constexpr auto operator()([[maybe_unused]] const std::size_t i,
+                                            const std::size_t col) const noexcept {
+        return data[col];
+    }
+};
+
+/**
+ * @brief Leaf holding a single value for every element.
+ */
+struct constant {
+    using expression_tag = void;
+
+    double value;
+
+    [[nodiscard]] constexpr auto operator()([[maybe_unused]] const std::size_t i,
+                                            [[maybe_unused]] const std::size_t col) const noexcept {
+        return value;
+    }
+};
+
+/**
+ * @brief Node combining two expressions elementwise.
+ */
+template <typename Op, expression L, expression R>
+struct binary {
+    using expression_tag = void;
+
+    L lhs;
+    R rhs;
+
+    [[nodiscard]] constexpr auto operator()(const std::size_t i,
+                                            const std::size_t col) const noexcept {
+        return Op{}(lhs(i, col), rhs(i, col));
+    }
+};
+
+/**
+ * @brief Node applying a scalar function, with optional extra parameters, to an expression.
+ */
+template <auto F, expression E, typename... Args>
+struct unary {
+    using expression_tag = void;
+
+    E arg;
+    std::tuple<Args...> params;
+
+    [[nodiscard]] constexpr auto operator()(const std::size_t i,
+                                            const std::size_t col) const noexcept {
+        return std::apply([&](const auto... ps) { return F(arg(i, col), ps...); }, params);
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief Wraps scalars into constant leaves and passes expressions through.
+ */
+template <typename T>
+[[nodiscard]] constexpr auto wrap(const T& val) noexcept {
+    if constexpr (expression<T>) {
+        return val;
+    } else {
+        return constant{static_cast<double>(val)};
+    }
+}
+
+/**
+ * @brief Requirement for operands of the arithmetic operators: at least one is an expression
+ * and the other is an expression or an arithmetic scalar.
+ */
+template <typename L, typename R>
+concept operands = (expression<L> || expression<R>) &&
+                   (expression<L> || std::is_arithmetic_v<L>) &&
+                   (expression<R> || std::is_arithmetic_v<R>);
+
+/**
+ * @brief Clamps a value to an interval.
+ */
+[[nodiscard]] constexpr auto clamp(const double z, const double lo, const double hi) noexcept {
+    return std::min(std::max(z, lo), hi);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Creates a leaf reading one value per element.
+ * @param data Values, one per output element.
+ * @return Expression leaf.
+ */
+[[nodiscard]] constexpr auto input(std::span<const double> data) noexcept {
+    return tensor{data};
+}
+
+/**
+ * @brief Creates a leaf reading a per-column bias, broadcast across rows.
+ * @param data Values, one per output column.
+ * @return Expression leaf.
+ */
+[[nodiscard]] constexpr auto bias(std::span<const double> data) noexcept {
+    return broadcast{data};
+}
+
+/**
+ * @brief Applies an activation from fun.hpp, or any scalar function, to an expression.
+ * @tparam F Function, e.g. fun::relu or fun::gelu<fun::gelu_mode::erf>.
+ * @param arg Argument expression.
+ * @param params Extra parameters passed after the argument, e.g. the scale of fun::elu.
+ * @return Expression node.
+ */
+template <auto F, expression E, typename... Args>
+[[nodiscard]] constexpr auto apply(const E& arg, const Args... params) noexcept {
+    return unary<F, E, Args...>{arg, {params...}};
+}
+
+/**
+ * @brief Clamps an expression to an interval.
+ * @param arg Argument expression.
+ * @param lo Lower bound.
+ * @param hi Upper bound.
+ * @return Expression node.
+ */
+template <expression E>
+[[nodiscard]] constexpr auto clamp(const E& arg, const double lo, const double hi) noexcept {
+    return apply<detail::clamp>(arg, lo, hi);
+}
+
+template <typename L, typename R>
+    requires detail::operands<L, R>
+[[nodiscard]] constexpr auto operator+(const L& lhs, const R& rhs) noexcept {
+    const auto l = detail::wrap(lhs);
+    const auto r = detail::wrap(rhs);
+    return binary<std::plus<>, decltype(l), decltype(r)>{l, r};
+}
+
+template <typename L, typename R>
+    requires detail::operands<L, R>
+[[nodiscard]] constexpr auto operator-(const L& lhs, const R& rhs) noexcept {
+    const auto l = detail::wrap(lhs);
+    const auto r = detail::wrap(rhs);
+    return binary<std::minus<>, decltype(l), decltype(r)>{l, r};
+}
+
+template <typename L, typename R>
+    requires detail::operands<L, R>
+[[nodiscard]] constexpr auto operator*(const L& lhs, const R& rhs) noexcept {
+    const auto l = detail::wrap(lhs);
+    const auto r = detail::wrap(rhs);
+    return binary<std::multiplies<>, decltype(l), decltype(r)>{l, r};
+}
+
+/**
+ * @brief Evaluates an expression over a row-major matrix in a single pass.
+ *
+ * Every operand is read once and the output written once, with no intermediate buffers. The
+ * expression is fully inlined into the inner loop, so branch-free activations vectorize.
+ *
+ * @param e Expression.
+ * @param out Output values, may alias any operand read per element; a partial last row is
+ * evaluated up to the end of the output.
+ * @param cols Number of columns, which broadcast leaves are indexed by, at least one; zero
+ * leaves the output untouched.
+ */
+template <expression E>
+constexpr void evaluate(const E& e, std::span<double> out, const std::size_t cols) noexcept {
+    if (cols == 0) {
+        return;
+    }
+    for (std::size_t row = 0; row < out.size(); row += cols) {
+        const auto width = std::min(cols, out.size() - row);
+        for (std::size_t col = 0; col < width; ++col) {
+            out[row + col] = e(row + col, col);
+        }
+    }
+}
+
+/**
+ * @brief Evaluates an expression over a vector in a single pass.
+ * @param e Expression.
+ * @param out Output values, may alias any operand read per element.
+ */
+template <expression E>
+constexpr void evaluate(const E& e, std::span<double> out) noexcept {
+    evaluate(e, out, out.size());
+}
+
+}  // namespace fun::expr
+
+#endif  // EXPR_HPP
@@ -25,6 +25,7 @@
 #ifndef FUN_HPP
 #define FUN_HPP
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <numeric>
@@ -34,31 +35,87 @@
 
 namespace fun {
 
+/**
+ * @brief Input above which softplus(z) and mish(z) round to z in double precision, so their
+ * linear regime is returned without evaluating any transcendental.
+ */
+static const constexpr auto SOFTPLUS_THRESHOLD = 36.0;
+
+/**
+ * @brief Cubic coefficient of the tanh approximation of GELU.
+ */
+static const constexpr auto GELU_TANH_CUBIC = 0.044715;
+
+/**
+ * @brief Scale sqrt(2 / π) of the tanh approximation of GELU.
+ */
+static const constexpr auto GELU_TANH_SCALE = constexpr_ops::sqrt(2 / constexpr_ops::PI);
+
+/**
+ * @brief Sigmoid scale of QuickGELU.
+ */
+static const constexpr auto QUICK_GELU_SCALE = 1.702;
+
+/**
+ * @brief Formulations of GELU, z Φ(z) with Φ the standard normal CDF.
+ */
+enum class gelu_mode {
+    erf,   // Exact: 0.5 z (1 + erf(z / sqrt(2))).
+    tanh,  // 0.5 z (1 + tanh(sqrt(2 / π) (z + 0.044715 z^3))).
+    quick  // QuickGELU: z σ(1.702 z).
+};
+
+/**
+ * @brief Runtime selector of an activation function, for kernels whose activation is only known
+ * when a model is loaded.
+ */
+enum class activation {
+    id,
+    binary_step,
+    sigmoid,
+    relu,
+    leaky_relu,
+    parametric_relu,  // Takes the slope as parameter.
+    gelu_erf,
+    gelu_tanh,
+    gelu_quick,
+    silu,
+    elu,  // Takes the scale as parameter.
+    softplus,
+    mish,
+    tanh,
+    gaussian,
+    gcs
+};
+
 /**
  * @brief Sigmoid activation function.
  * @param z Input value.
  * @return Value after activation via Sigmoid.
  */
 [[nodiscard]] constexpr auto sigmoid(const double z) noexcept {
-    auto expval = constexpr_ops::exp(z);
-    return z < 0 ? expval / (1 + expval) : 1 / (1 + constexpr_ops::exp(-z));
+    auto expval = constexpr_ops::exp(-constexpr_ops::abs(z));
+    return (z < 0 ? expval : 1) / (1 + expval);
 }
 
 /**
  * @brief Softmax activation function.
- * @param z Input vector.
- * @return Value after activation via Softmax.
+ * @param zs Input vector.
+ * @return Value after activation via Softmax, empty for an empty input.
  */
 template <typename T>
 [[nodiscard]] constexpr auto softmax(const T& zs) noexcept {
-    auto acc = static_cast<T>(0);
-    auto expsum = std::accumulate(zs.begin(), zs.end(), acc, [](const auto& lhs, const auto& rhs) {
-        return lhs + constexpr_ops::exp(rhs);
-    });
-
-    std::vector<T> result = zs;
+    if (zs.begin() == zs.end()) {
+        return zs;
+    }
+    // Shifting by the maximum keeps every exponential in [0, 1], so large logits cannot overflow.
+    const auto max = *std::max_element(zs.begin(), zs.end());
+    auto result = zs;
     std::for_each(result.begin(), result.end(),
-                  [&](auto& val) { val = constexpr_ops::exp(val) / expsum; });
+                  [&](auto& val) { val = constexpr_ops::exp(val - max); });
+
+    const auto expsum = std::accumulate(result.begin(), result.end(), 0.0);
+    std::for_each(result.begin(), result.end(), [&](auto& val) { val /= expsum; });
 
     return result;
 }
@@ -93,12 +150,23 @@ template <typename T>
 
 /**
  * @brief Gaussian Error Linear Unit (GELU) activation function.
+ *
+ * Φ(z) is evaluated as 0.5 erfc(-z / sqrt(2)) and 0.5 (1 + tanh(u)) as σ(2u), so none of the
+ * formulations cancels for negative inputs.
+ *
+ * @tparam Mode Formulation of GELU, the tanh approximation by default.
  * @param z Input value.
  * @return Value after activation via GELU.
  */
+template <gelu_mode Mode = gelu_mode::tanh>
 [[nodiscard]] constexpr auto gelu(const double z) noexcept {
-    return 0.5 * z *
-           (1 + tanh(constexpr_ops::sqrt(2 / constexpr_ops::PI) * (z + 0.044715 * z * z * z)));
+    if constexpr (Mode == gelu_mode::erf) {
+        return 0.5 * z * constexpr_ops::erfc(-z * constexpr_ops::SQRT1_2);
+    } else if constexpr (Mode == gelu_mode::tanh) {
+        return z * sigmoid(2 * GELU_TANH_SCALE * (z + GELU_TANH_CUBIC * z * z * z));
+    } else {
+        return z * sigmoid(QUICK_GELU_SCALE * z);
+    }
 }
 
 /**
@@ -117,7 +185,7 @@ template <typename T>
  * @return Value after activation via ELU.
  */
 [[nodiscard]] constexpr auto elu(const double z, const double a) noexcept {
-    return z < 0 ? a * (constexpr_ops::exp(z) - 1) : z;
+    return z < 0 ? a * constexpr_ops::expm1(z) : z;
 }
 
 /**
@@ -126,7 +194,10 @@ template <typename T>
  * @return Value after activation via Softplus.
  */
 [[nodiscard]] constexpr auto softplus(const double z) noexcept {
-    return constexpr_ops::ln(1 + constexpr_ops::exp(z));
+    if (z > SOFTPLUS_THRESHOLD) {
+        return z;
+    }
+    return (z < 0 ? 0 : z) + constexpr_ops::log1p(constexpr_ops::exp(-constexpr_ops::abs(z)));
 }
 
 /**
@@ -135,7 +206,13 @@ template <typename T>
  * @return Value after activation via Mish.
  */
 [[nodiscard]] constexpr auto mish(const double z) noexcept {
-    return z * tanh(softplus(z));
+    if (z > SOFTPLUS_THRESHOLD) {
+        return z;
+    }
+    // tanh(ln(1 + e)) = n / (n + 2) with n = e (e + 2), which needs a single exp.
+    const auto expval = constexpr_ops::exp(z);
+    const auto n = expval * (expval + 2);
+    return z * n / (n + 2);
 }
 
 /**
@@ -225,13 +302,25 @@ namespace derivative {
 
 /**
  * @brief Derivative of the GELU activation function.
+ * @tparam Mode Formulation of GELU, the tanh approximation by default.
  * @param z Input value.
  * @return GELU derivative.
  */
+template <gelu_mode Mode = gelu_mode::tanh>
 [[nodiscard]] constexpr auto gelu(const double z) noexcept {
-    auto cube = z * z * z;
-    auto tmp = 0.0356774 * cube + 0.797885 * z;
-    return 0.5 * tanh(tmp) + (0.0535161 * cube + 0.398942 * z) / constexpr_ops::cosh(tmp) + 0.5;
+    if constexpr (Mode == gelu_mode::erf) {
+        const auto pdf = constexpr_ops::exp(-0.5 * z * z) * constexpr_ops::SQRT1_2 * 0.5 *
+                         constexpr_ops::TWO_OVER_SQRTPI;
+        return 0.5 * constexpr_ops::erfc(-z * constexpr_ops::SQRT1_2) + z * pdf;
+    } else if constexpr (Mode == gelu_mode::tanh) {
+        const auto z2 = z * z;
+        const auto sigval = fun::sigmoid(2 * GELU_TANH_SCALE * z * (1 + GELU_TANH_CUBIC * z2));
+        const auto du = 2 * GELU_TANH_SCALE * (1 + 3 * GELU_TANH_CUBIC * z2);
+        return sigval + z * du * sigval * (1 - sigval);
+    } else {
+        const auto sigval = fun::sigmoid(QUICK_GELU_SCALE * z);
+        return sigval + QUICK_GELU_SCALE * z * sigval * (1 - sigval);
+    }
 }
 
 /**
@@ -268,6 +357,9 @@ namespace derivative {
  * @return Mish derivative.
  */
 [[nodiscard]] constexpr auto mish(const double z) noexcept {
+    if (z > SOFTPLUS_THRESHOLD) {
+        return 1.0;
+    }
     auto omega = constexpr_ops::exp(3 * z) + 4 * constexpr_ops::exp(2 * z) +
                  (4 * z + 6) * constexpr_ops::exp(z) + 4 * (z + 1);
     auto tmp = constexpr_ops::exp(z) + 1;
@@ -0,0 +1,210 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GLU_HPP
+#define GLU_HPP
+
+#include <cstddef>
+#include <span>
+
+#include "constexpr_ops.hpp"
+#include "fun.hpp"
+#include "matrix.hpp"
+
+namespace fun {
+
+/**
+ * @brief Gated linear unit variants, act(gate) * up, named after the gate activation.
+ */
+enum class glu_variant {
+    swiglu,      // SiLU gate.
+    geglu,       // Exact (erf) GELU gate.
+    geglu_tanh,  // Tanh-approximated GELU gate.
+    reglu        // ReLU gate.
+};
+
+/**
+ * @brief Layouts of the gate and up projections within one row of a fused projection output.
+ */
+enum class glu_layout {
+    concatenated,  // [g_0, ..., g_{H-1}, u_0, ..., u_{H-1}].
+    interleaved    // [g_0, u_0, g_1, u_1, ...].
+};
+
+namespace detail {
+
+/**
+ * @brief Value of a gate activation together with its derivative.
+ */
+struct value_derivative {
+    double value;
+    double derivative;
+};
+
+/**
+ * @brief Evaluates a gate activation and its derivative, sharing the transcendental between them.
+ * @tparam V GLU variant.
+ * @param z Gate value.
+ * @return Activation value and derivative.
+ */
+template <glu_variant V>
+[[nodiscard]] constexpr auto gate_activation(const double z) noexcept {
+    if constexpr (V == glu_variant::swiglu) {
+        const auto sigval = fun::sigmoid(z);
+        return value_derivative{z * sigval, sigval * (1 + z * (1 - sigval))};
+    } else if constexpr (V == glu_variant::geglu) {
+        const auto cdf = 0.5 * constexpr_ops::erfc(-z * constexpr_ops::SQRT1_2);
+        const auto pdf = constexpr_ops::exp(-0.5 * z * z) * constexpr_ops::SQRT1_2 * 0.5 *
+                         constexpr_ops::TWO_OVER_SQRTPI;
+        return value_derivative{z * cdf, cdf + z * pdf};
+    } else if constexpr (V == glu_variant::geglu_tanh) {
+        const auto z2 = z * z;
+        const auto sigval = fun::sigmoid(2 * GELU_TANH_SCALE * z * (1 + GELU_TANH_CUBIC * z2));
+        const auto du = 2 * GELU_TANH_SCALE * (1 + 3 * GELU_TANH_CUBIC * z2);
+        return value_derivative{z * sigval, sigval + z * du * sigval * (1 - sigval)};
+    } else {
+        return z < 0 ? value_derivative{0, 0} : value_derivative{z, 1};
+    }
+}
+
+/**
+ * @brief GLU forward pass over one row.
+ * @tparam V GLU variant.
+ * @tparam S Distance between consecutive gate (and up) values, 2 for interleaved layouts.
+ * @param gate Gate values.
+ * @param up Up projection values.
+ * @param out Output values, one per gate value.
+ */
+template <glu_variant V, std::size_t S>
+constexpr void glu_forward(std::span<const double> gate, std::span<const double> up,
+                           std::span<double> out) noexcept {
+    for (std::size_t j = 0; j < out.size(); ++j) {
+        out[j] = gate_activation<V>(gate[j * S]).value * up[j * S];
+    }
+}
+
+/**
+ * @brief GLU backward pass over one row.
+ * @tparam V GLU variant.
+ * @tparam S Distance between consecutive gate (and up) values, 2 for interleaved layouts.
+ * @param gate Gate values.
+ * @param up Up projection values.
+ * @param grad Gradient of the loss with respect to the output.
+ * @param grad_gate Gradient with respect to the gate values, laid out like them.
+ * @param grad_up Gradient with respect to the up projection values, laid out like them.
+ */
+template <glu_variant V, std::size_t S>
+constexpr void glu_backward(std::span<const double> gate, std::span<const double> up,
+                            std::span<const double> grad, std::span<double> grad_gate,
+                            std::span<double> grad_up) noexcept {
+    for (std::size_t j = 0; j < grad.size(); ++j) {
+        const auto act = gate_activation<V>(gate[j * S]);
+        const auto u = up[j * S];
+        grad_gate[j * S] = grad[j] * u * act.derivative;
+        grad_up[j * S] = grad[j] * act.value;
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Gated linear unit act(gate) * up over separate gate and up projections.
+ * @tparam V GLU variant.
+ * @param gate Gate values.
+ * @param up Up projection values, same size as the gate.
+ * @param out Output values, same size as the gate, may alias either input.
+ */
+template <glu_variant V>
+constexpr void glu(std::span<const double> gate, std::span<const double> up,
+                   std::span<double> out) noexcept {
+    detail::glu_forward<V, 1>(gate, up, out);
+}
+
+/**
+ * @brief Gated linear unit over a fused projection holding gate and up values in each row.
+ * @tparam V GLU variant.
+ * @param in Fused projection with 2H columns.
+ * @param out Output matrix with H columns and as many rows.
+ * @param layout Arrangement of gate and up values within a row.
+ */
+template <glu_variant V>
+constexpr void glu(matrix_view<const double> in, matrix_view<double> out,
+                   const glu_layout layout) noexcept {
+    for (std::size_t i = 0; i < in.rows; ++i) {
+        const auto row = in.row(i);
+        if (layout == glu_layout::concatenated) {
+            detail::glu_forward<V, 1>(row.first(out.cols), row.subspan(out.cols), out.row(i));
+        } else {
+            detail::glu_forward<V, 2>(row, row.subspan(1), out.row(i));
+        }
+    }
+}
+
+/**
+ * @brief Backward pass of the gated linear unit over separate gate and up projections.
+ *
+ * The gate activation and its derivative are evaluated once per element and give both input
+ * gradients, so the activated gate never has to be stored by the forward pass.
+ *
+ * @tparam V GLU variant.
+ * @param gate Gate values.
+ * @param up Up projection values, same size as the gate.
+ * @param grad Gradient of the loss with respect to the output.
+ * @param grad_gate Gradient with respect to the gate values.
+ * @param grad_up Gradient with respect to the up projection values.
+ */
+template <glu_variant V>
+constexpr void glu_backward(std::span<const double> gate, std::span<const double> up,
+                            std::span<const double> grad, std::span<double> grad_gate,
+                            std::span<double> grad_up) noexcept {
+    detail::glu_backward<V, 1>(gate, up, grad, grad_gate, grad_up);
+}
+
+/**
+ * @brief Backward pass of the gated linear unit over a fused projection.
+ * @tparam V GLU variant.
+ * @param in Fused projection with 2H columns.
+ * @param grad Gradient of the loss with respect to the output, H columns.
+ * @param grad_in Gradient with respect to the fused projection, laid out like it.
+ * @param layout Arrangement of gate and up values within a row.
+ */
+template <glu_variant V>
+constexpr void glu_backward(matrix_view<const double> in, matrix_view<const double> grad,
+                            matrix_view<double> grad_in, const glu_layout layout) noexcept {
+    for (std::size_t i = 0; i < in.rows; ++i) {
+        const auto row = in.row(i);
+        const auto grad_row = grad_in.row(i);
+        if (layout == glu_layout::concatenated) {
+            detail::glu_backward<V, 1>(row.first(grad.cols), row.subspan(grad.cols), grad.row(i),
+                                       grad_row.first(grad.cols), grad_row.subspan(grad.cols));
+        } else {
+            detail::glu_backward<V, 2>(row, row.subspan(1), grad.row(i), grad_row,
+                                       grad_row.subspan(1));
+        }
+    }
+}
+
+}  // namespace fun
+
+#endif  // GLU_HPP
@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GUMBEL_HPP
+#define GUMBEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "constexpr_ops.hpp"
+#include "matrix.hpp"
+#include "random.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+namespace detail {
+
+/**
+ * @brief Writes the perturbed and scaled logits (z + g) / temperature of one row.
+ *
+ * The Gumbel noise g = -log(-log(u)) of an element is a pure function of the seed, the step and
+ * the element's position, so it is generated on the fly here and regenerated by the backward
+ * pass instead of being stored.
+ *
+ * @param zs Logits of the row.
+ * @param out Output values, may alias the logits.
+ * @param inv_temperature Inverse of the temperature.
+ * @param seed Seed of the noise.
+ * @param step Draw number, such as the training step.
+ * @param first Position of the first element of the row in the batch.
+ */
+constexpr void perturb(std::span<const double> zs, std::span<double> out,
+                       const double inv_temperature, const std::uint64_t seed,
+                       const std::uint64_t step, const std::size_t first) noexcept {
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        const auto u = uniform(seed, first + j, step);
+        out[j] = (zs[j] - constexpr_ops::log(-constexpr_ops::log(u))) * inv_temperature;
+    }
+}
+
+/**
+ * @brief Relaxed sample softmax((z + g) / temperature) of one row.
+ */
+constexpr void gumbel_row(std::span<const double> zs, std::span<double> out,
+                          const double temperature, const std::uint64_t seed,
+                          const std::uint64_t step, const std::size_t first) noexcept {
+    perturb(zs, out, 1 / temperature, seed, step, first);
+    softmax(out, out);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Gumbel-softmax forward pass over every row, fused with the noise generation.
+ *
+ * Each row becomes softmax((z + g) / temperature) with Gumbel noise g drawn from the
+ * counter-based generator of random.hpp, so the noise, the perturbed logits and the softmax take
+ * a single pass without a noise buffer. In hard mode the row is the one-hot vector of its
+ * largest perturbed logit, an exact sample of softmax(z), and the backward pass then treats it
+ * as the relaxed sample, which is the straight-through estimator.
+ *
+ * @param logits Input rows.
+ * @param out Output rows of the same shape, may alias the input.
+ * @param temperature Positive temperature, lower values approach one-hot outputs.
+ * @param seed Seed of the noise.
+ * @param step Draw number, such as the training step; the backward pass must get the same one.
+ * @param hard Whether to output one-hot vectors.
+ */
+constexpr void gumbel_softmax(matrix_view<const double> logits, matrix_view<double> out,
+                              const double temperature, const std::uint64_t seed,
+                              const std::uint64_t step = 0, const bool hard = false) noexcept {
+    for (std::size_t i = 0; i < logits.rows; ++i) {
+        const auto row = out.row(i);
+        detail::gumbel_row(logits.row(i), row, temperature, seed, step, i * logits.cols);
+        if (hard) {
+            std::size_t best = 0;
+            for (std::size_t j = 1; j < row.size(); ++j) {
+                best = row[j] > row[best] ? j : best;
+            }
+            for (std::size_t j = 0; j < row.size(); ++j) {
+                row[j] = j == best ? 1.0 : 0.0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Gumbel-softmax backward pass, for the soft and the straight-through hard variants.
+ *
+ * The relaxed sample y is recomputed from the logits and the regenerated noise, and the
+ * gradient is y * (g - sum(y * g)) / temperature for the output gradient g.
+ *
+ * @param logits Input rows of the forward pass.
+ * @param grad Gradient with respect to the output.
+ * @param grad_logits Gradient with respect to the logits, may alias the logits but not grad.
+ * @param temperature Temperature of the forward pass.
+ * @param seed Seed of the forward pass.
+ * @param step Draw number of the forward pass.
+ */
+constexpr void gumbel_softmax_backward(matrix_view<const double> logits,
+                                       matrix_view<const double> grad,
+                                       matrix_view<double> grad_logits, const double temperature,
+                                       const std::uint64_t seed,
+                                       const std::uint64_t step = 0) noexcept {
+    for (std::size_t i = 0; i < logits.rows; ++i) {
+        const auto g = grad.row(i);
+        const auto res = grad_logits.row(i);
+        detail::gumbel_row(logits.row(i), res, temperature, seed, step, i * logits.cols);
+        auto dot = 0.0;
+        for (std::size_t j = 0; j < res.size(); ++j) {
+            dot += res[j] * g[j];
+        }
+        for (std::size_t j = 0; j < res.size(); ++j) {
+            res[j] = res[j] * (g[j] - dot) / temperature;
+        }
+    }
+}
+
+}  // namespace fun
+
+#endif  // GUMBEL_HPP
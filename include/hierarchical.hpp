@@ -0,0 +1,260 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HIERARCHICAL_HPP
+#define HIERARCHICAL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "constexpr_ops.hpp"
+#include "matrix.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+/**
+ * @brief Two-level grouping of the classes of a hierarchical softmax.
+ */
+struct class_tree {
+    std::vector<std::size_t> offsets;  // Start of each cluster in members, then their total.
+    std::vector<std::size_t> members;  // Classes grouped by cluster.
+    std::vector<std::size_t> cluster;  // Cluster of each class.
+    std::vector<std::size_t> slot;     // Position of each class within its cluster.
+
+    /**
+     * @brief Number of clusters.
+     */
+    [[nodiscard]] auto clusters() const noexcept {
+        return offsets.size() - 1;
+    }
+
+    /**
+     * @brief Classes of a cluster.
+     * @param k Cluster index.
+     */
+    [[nodiscard]] auto classes(const std::size_t k) const noexcept {
+        return std::span<const std::size_t>(members).subspan(offsets[k],
+                                                             offsets[k + 1] - offsets[k]);
+    }
+};
+
+/**
+ * @brief Groups classes into clusters of roughly equal frequency mass.
+ *
+ * Classes are taken from the most to the least frequent, and a cluster is closed once it holds
+ * its share of the total mass or twice the average number of classes. Frequent classes thus sit
+ * in small clusters, which keeps the expected cost of an example low, while the size cap bounds
+ * the cost of the rare ones, about sqrt(V) each for the default number of clusters. If all
+ * frequencies are zero, the classes are split into clusters of equal size instead.
+ *
+ * @param frequencies Non-negative frequency of each class.
+ * @param clusters Target number of clusters, zero for ceil(sqrt(V)); the result may hold up to
+ * half as many again.
+ * @return Cluster tree over the classes.
+ */
+[[nodiscard]] inline auto build_class_tree(std::span<const double> frequencies,
+                                           std::size_t clusters = 0) {
+    const auto n = frequencies.size();
+    if (clusters == 0) {
+        clusters = 1;
+        while (clusters * clusters < n) {
+            ++clusters;
+        }
+    }
+
+    class_tree tree;
+    tree.members.resize(n);
+    std::iota(tree.members.begin(), tree.members.end(), std::size_t{0});
+    std::stable_sort(tree.members.begin(), tree.members.end(),
+                     [&](const std::size_t a, const std::size_t b) {
+                         return frequencies[a] > frequencies[b];
+                     });
+
+    // Without any mass to balance, fall back to clusters of equal size.
+    const auto total = std::accumulate(frequencies.begin(), frequencies.end(), 0.0);
+    const auto uniform = !(total > 0);
+    const auto share = uniform ? std::numeric_limits<double>::infinity()
+                               : total / static_cast<double>(clusters);
+    const auto average = (n + clusters - 1) / clusters;
+    const auto cap = std::max<std::size_t>(1, uniform ? average : 2 * average);
+    tree.cluster.resize(n);
+    tree.slot.resize(n);
+    tree.offsets.push_back(0);
+    auto mass = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto c = tree.members[i];
+        const auto size = i - tree.offsets.back();
+        if (size > 0 && (mass >= share || size >= cap)) {
+            tree.offsets.push_back(i);
+            mass = 0;
+        }
+        tree.cluster[c] = tree.offsets.size() - 1;
+        tree.slot[c] = i - tree.offsets.back();
+        mass += frequencies[c];
+    }
+    tree.offsets.push_back(n);
+    return tree;
+}
+
+namespace detail {
+
+/**
+ * @brief Dot product of two vectors of the same length.
+ */
+[[nodiscard]] constexpr auto dot(std::span<const double> a, std::span<const double> b) noexcept {
+    auto res = 0.0;
+    for (std::size_t j = 0; j < a.size(); ++j) {
+        res += a[j] * b[j];
+    }
+    return res;
+}
+
+/**
+ * @brief Adds a scaled vector to another.
+ */
+constexpr void axpy(const double alpha, std::span<const double> x, std::span<double> y) noexcept {
+    for (std::size_t j = 0; j < x.size(); ++j) {
+        y[j] += alpha * x[j];
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Log-probability of a class under a hierarchical softmax.
+ *
+ * log p(y | h) = log softmax(Wc h)[k] + log softmax(Wo[classes of k] h)[y] for the cluster k of
+ * y, which touches C + |k| weight rows instead of all V.
+ *
+ * @param hidden Input vector.
+ * @param tree Cluster tree.
+ * @param cluster_weights One row per cluster.
+ * @param class_weights One row per class.
+ * @param target Class.
+ * @return Log-probability of the class.
+ */
+[[nodiscard]] inline auto hierarchical_log_probability(std::span<const double> hidden,
+                                                       const class_tree& tree,
+                                                       matrix_view<const double> cluster_weights,
+                                                       matrix_view<const double> class_weights,
+                                                       const std::size_t target) {
+    const auto k = tree.cluster[target];
+    const auto classes = tree.classes(k);
+    std::vector<double> logits(std::max(tree.clusters(), classes.size()));
+
+    const auto outer = std::span<double>(logits).first(tree.clusters());
+    for (std::size_t c = 0; c < outer.size(); ++c) {
+        outer[c] = detail::dot(cluster_weights.row(c), hidden);
+    }
+    auto res = outer[k] - log_sum_exp(outer);
+
+    const auto inner = std::span<double>(logits).first(classes.size());
+    for (std::size_t s = 0; s < inner.size(); ++s) {
+        inner[s] = detail::dot(class_weights.row(classes[s]), hidden);
+    }
+    return res + inner[tree.slot[target]] - log_sum_exp(inner);
+}
+
+/**
+ * @brief Mean negative log-likelihood of a batch under a hierarchical softmax and its gradients.
+ *
+ * For each example the cluster logits and the logits of the target's cluster are computed,
+ * normalized and turned into the softmax - one-hot gradients of both levels, which are then
+ * propagated to the weights and the input. Only the rows of the target clusters receive class
+ * weight gradients.
+ *
+ * @param hidden Input vectors, one row per example.
+ * @param targets Class of each example.
+ * @param tree Cluster tree.
+ * @param cluster_weights One row per cluster, as wide as the input.
+ * @param class_weights One row per class, as wide as the input.
+ * @param grad_hidden Gradient with respect to the input, overwritten.
+ * @param grad_cluster_weights Gradient with respect to the cluster weights, accumulated into.
+ * @param grad_class_weights Gradient with respect to the class weights, accumulated into.
+ * @return Mean loss over the batch.
+ */
+inline auto hierarchical_softmax_loss(matrix_view<const double> hidden,
+                                      std::span<const std::size_t> targets,
+                                      const class_tree& tree,
+                                      matrix_view<const double> cluster_weights,
+                                      matrix_view<const double> class_weights,
+                                      matrix_view<double> grad_hidden,
+                                      matrix_view<double> grad_cluster_weights,
+                                      matrix_view<double> grad_class_weights) {
+    if (hidden.rows == 0) {
+        return 0.0;
+    }
+    const auto scale = 1 / static_cast<double>(hidden.rows);
+    auto widest = std::size_t{0};
+    for (std::size_t k = 0; k < tree.clusters(); ++k) {
+        widest = std::max(widest, tree.classes(k).size());
+    }
+    std::vector<double> outer(tree.clusters());
+    std::vector<double> inner(widest);
+
+    auto loss = 0.0;
+    for (std::size_t i = 0; i < hidden.rows; ++i) {
+        const auto h = hidden.row(i);
+        const auto gh = grad_hidden.row(i);
+        std::fill(gh.begin(), gh.end(), 0.0);
+        const auto y = targets[i];
+        const auto k = tree.cluster[y];
+        const auto classes = tree.classes(k);
+        const auto logits = std::span<double>(inner).first(classes.size());
+
+        for (std::size_t c = 0; c < outer.size(); ++c) {
+            outer[c] = detail::dot(cluster_weights.row(c), h);
+        }
+        for (std::size_t s = 0; s < logits.size(); ++s) {
+            logits[s] = detail::dot(class_weights.row(classes[s]), h);
+        }
+        const auto outer_sum = detail::reduce(outer);
+        const auto inner_sum = detail::reduce(logits);
+        loss -= outer[k] - detail::log_sum(outer_sum) + logits[tree.slot[y]] -
+                detail::log_sum(inner_sum);
+
+        detail::normalize(outer, outer, outer_sum);
+        outer[k] -= 1;
+        for (std::size_t c = 0; c < outer.size(); ++c) {
+            detail::axpy(scale * outer[c], h, grad_cluster_weights.row(c));
+            detail::axpy(scale * outer[c], cluster_weights.row(c), gh);
+        }
+        detail::normalize(logits, logits, inner_sum);
+        logits[tree.slot[y]] -= 1;
+        for (std::size_t s = 0; s < logits.size(); ++s) {
+            detail::axpy(scale * logits[s], h, grad_class_weights.row(classes[s]));
+            detail::axpy(scale * logits[s], class_weights.row(classes[s]), gh);
+        }
+    }
+    return loss * scale;
+}
+
+}  // namespace fun
+
+#endif  // HIERARCHICAL_HPP
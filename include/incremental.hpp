@@ -0,0 +1,239 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "constexpr_ops.hpp"
+#include "random.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+/**
+ * @brief Distance in nats between the largest logit and the shift of the stored weights beyond
+ * which the weights are rebuilt, keeping them far from overflow and underflow.
+ */
+static const constexpr double INCREMENTAL_REBASE = 64;
+
+/**
+ * @brief Softmax over a set of logits that change one at a time.
+ *
+ * The weights exp(z - shift) sit in the leaves of a sum tree whose root is the normalizer, so
+ * updating, inserting or removing a logit costs O(log n) instead of a full softmax, the
+ * log-normalizer and any probability come in O(1), and sampling walks down the tree in O(log n).
+ * Parents are recomputed from their children rather than patched with differences, so the sums
+ * do not drift however many updates are applied. The shift follows the largest logit lazily: it
+ * is only reset, with an O(n) rebuild, when a logit rises INCREMENTAL_REBASE above it or the
+ * total falls below exp(-INCREMENTAL_REBASE).
+ *
+ * Indices are stable handles: removing a logit leaves a vacant slot that the next insertion
+ * reuses.
+ */
+class incremental_softmax {
+   public:
+    incremental_softmax() = default;
+
+    /**
+     * @brief Builds the structure in O(n).
+     * @param zs Initial logits, indexed from zero.
+     */
+    explicit incremental_softmax(std::span<const double> zs) : logits_(zs.begin(), zs.end()) {
+        rebuild();
+    }
+
+    /**
+     * @brief Number of logits currently held.
+     */
+    [[nodiscard]] auto size() const noexcept {
+        return logits_.size() - vacant_.size();
+    }
+
+    /**
+     * @brief Accesses a logit.
+     * @param i Index of a held logit.
+     * @return The logit.
+     */
+    [[nodiscard]] auto logit(const std::size_t i) const noexcept {
+        return logits_[i];
+    }
+
+    /**
+     * @brief Adds a logit.
+     * @param z Logit.
+     * @return Index of the new logit, a vacant slot if there is one.
+     */
+    auto insert(const double z) {
+        if (vacant_.empty()) {
+            logits_.push_back(z);
+            if (logits_.size() > leaves()) {
+                rebuild();
+                return logits_.size() - 1;
+            }
+            set(logits_.size() - 1, z);
+            return logits_.size() - 1;
+        }
+        const auto i = vacant_.back();
+        vacant_.pop_back();
+        set(i, z);
+        return i;
+    }
+
+    /**
+     * @brief Changes a logit.
+     * @param i Index of a held logit.
+     * @param z New logit.
+     */
+    void update(const std::size_t i, const double z) {
+        set(i, z);
+    }
+
+    /**
+     * @brief Removes a logit, leaving its index vacant.
+     * @param i Index of a held logit.
+     */
+    void remove(const std::size_t i) {
+        vacant_.push_back(i);
+        set(i, -std::numeric_limits<double>::infinity());
+    }
+
+    /**
+     * @brief Log-normalizer, the log-sum-exp of the held logits.
+     */
+    [[nodiscard]] auto log_normalizer() const noexcept {
+        return tree_[1] > 0 ? shift_ + constexpr_ops::log(tree_[1])
+                            : -std::numeric_limits<double>::infinity();
+    }
+
+    /**
+     * @brief Log-probability of a logit, exact even where its weight underflows.
+     * @param i Index of a held logit.
+     */
+    [[nodiscard]] auto log_probability(const std::size_t i) const noexcept {
+        return logits_[i] - log_normalizer();
+    }
+
+    /**
+     * @brief Probability of a logit.
+     * @param i Index of a held logit.
+     */
+    [[nodiscard]] auto probability(const std::size_t i) const noexcept {
+        return constexpr_ops::exp(log_probability(i));
+    }
+
+    /**
+     * @brief Draws an index with probability proportional to exp(logit).
+     *
+     * The walk only enters subtrees of positive weight, so vacant slots and rounding at the edge
+     * of the last interval never produce an index without mass.
+     *
+     * @param u Uniform variate in [0, 1).
+     * @return Sampled index, zero when no logit has mass.
+     */
+    [[nodiscard]] auto sample(const double u) const noexcept {
+        auto target = u * tree_[1];
+        std::size_t k = 1;
+        while (k < leaves()) {
+            const auto left = tree_[2 * k];
+            if (target < left || !(tree_[2 * k + 1] > 0)) {
+                k = 2 * k;
+            } else {
+                target -= left;
+                k = 2 * k + 1;
+            }
+        }
+        return k - leaves();
+    }
+
+    /**
+     * @brief Draws an index with the counter-based generator of random.hpp.
+     * @param seed Stream seed.
+     * @param counter Draw number, so that draws are reproducible and independent.
+     * @return Sampled index.
+     */
+    [[nodiscard]] auto sample(const std::uint64_t seed,
+                              const std::uint64_t counter) const noexcept {
+        return sample(uniform(seed, counter));
+    }
+
+   private:
+    /**
+     * @brief Number of leaves, a power of two.
+     */
+    [[nodiscard]] std::size_t leaves() const noexcept {
+        return tree_.size() / 2;
+    }
+
+    /**
+     * @brief Stores a logit and refreshes its path to the root, rebuilding if the shift is off.
+     */
+    void set(const std::size_t i, const double z) {
+        logits_[i] = z;
+        if (z > shift_ + INCREMENTAL_REBASE) {
+            rebuild();
+            return;
+        }
+        auto k = leaves() + i;
+        tree_[k] = constexpr_ops::exp(z - shift_);
+        for (k /= 2; k > 0; k /= 2) {
+            tree_[k] = tree_[2 * k] + tree_[2 * k + 1];
+        }
+        if (tree_[1] < constexpr_ops::exp(-INCREMENTAL_REBASE) && size() > 0) {
+            rebuild();
+        }
+    }
+
+    /**
+     * @brief Recomputes the shift and every weight in O(n).
+     */
+    void rebuild() {
+        const auto n = std::bit_ceil(std::max<std::size_t>(logits_.size(), 1));
+        const auto max = detail::max_of(logits_);
+        shift_ = max > -std::numeric_limits<double>::infinity() ? max : shift_;
+        tree_.assign(2 * n, 0.0);
+        for (std::size_t i = 0; i < logits_.size(); ++i) {
+            tree_[n + i] = constexpr_ops::exp(logits_[i] - shift_);
+        }
+        for (auto k = n - 1; k > 0; --k) {
+            tree_[k] = tree_[2 * k] + tree_[2 * k + 1];
+        }
+    }
+
+    std::vector<double> logits_;
+    std::vector<std::size_t> vacant_;
+    std::vector<double> tree_ = std::vector<double>(2, 0.0);
+    double shift_ = 0;
+};
+
+}  // namespace fun
+
+#endif  // INCREMENTAL_HPP
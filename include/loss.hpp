@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LOSS_HPP
+#define LOSS_HPP
+
+#include <cstddef>
+#include <span>
+
+#include "constexpr_ops.hpp"
+#include "parallel.hpp"
+
+namespace fun {
+
+namespace detail {
+
+/**
+ * @brief Binary cross-entropy with logits over part of a batch, writing the gradient.
+ * @param logits Logits.
+ * @param targets Targets in [0, 1].
+ * @param weights Per-example weights, empty for unit weights.
+ * @param grad Gradient output, empty to skip the backward pass.
+ * @param scale Factor applied to the gradient.
+ * @param begin First example.
+ * @param end One past the last example.
+ * @return Sum of the weighted losses.
+ */
+inline auto bce_range(std::span<const double> logits, std::span<const double> targets,
+                      std::span<const double> weights, std::span<double> grad, const double scale,
+                      const std::size_t begin, const std::size_t end) noexcept {
+    auto res = 0.0;
+    for (auto i = begin; i < end; ++i) {
+        const auto z = logits[i];
+        const auto y = targets[i];
+        const auto w = weights.empty() ? 1.0 : weights[i];
+        // exp(-|z|) is shared by the loss and by sigmoid(z) in the gradient.
+        const auto e = constexpr_ops::exp(-constexpr_ops::abs(z));
+        res += w * ((z > 0 ? z : 0) - z * y + constexpr_ops::log1p(e));
+        if (!grad.empty()) {
+            grad[i] = scale * w * ((z < 0 ? e : 1) / (1 + e) - y);
+        }
+    }
+    return res;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Mean binary cross-entropy with logits and its gradient in one pass.
+ *
+ * Each loss is max(z, 0) - z * y + log1p(exp(-|z|)), which never takes the logarithm of a
+ * probability that rounded to zero or one. Blocks of the batch are reduced on separate threads
+ * and their partial sums combined along the pairwise tree of parallel::sum, so the result does
+ * not depend on the number of threads.
+ *
+ * @param logits Logits.
+ * @param targets Targets in [0, 1].
+ * @param weights Per-example weights, empty for unit weights.
+ * @param grad Gradient of the mean loss with respect to the logits, empty to skip it.
+ * @return Mean of the weighted losses over the batch.
+ */
+inline auto bce_with_logits(std::span<const double> logits, std::span<const double> targets,
+                            std::span<const double> weights, std::span<double> grad) {
+    const auto n = logits.size();
+    if (n == 0) {
+        return 0.0;
+    }
+    const auto scale = 1 / static_cast<double>(n);
+    const auto total = parallel::sum(n, [&](const std::size_t begin, const std::size_t end) {
+        return detail::bce_range(logits, targets, weights, grad, scale, begin, end);
+    });
+    return total * scale;
+}
+
+/**
+ * @brief Mean binary cross-entropy with logits.
+ * @param logits Logits.
+ * @param targets Targets in [0, 1].
+ * @param weights Per-example weights, empty for unit weights.
+ * @return Mean of the weighted losses over the batch.
+ */
+[[nodiscard]] inline auto bce_with_logits(std::span<const double> logits,
+                                          std::span<const double> targets,
+                                          std::span<const double> weights = {}) {
+    return bce_with_logits(logits, targets, weights, {});
+}
+
+}  // namespace fun
+
+#endif  // LOSS_HPP
@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+namespace fun {
+
+/**
+ * @brief Non-owning view of a row-major matrix whose rows may be padded.
+ * @tparam T Element type, const-qualified for read-only views.
+ */
+template <typename T>
+struct matrix_view {
+    T* data = nullptr;
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    std::size_t stride = 0;
+
+    constexpr matrix_view() noexcept = default;
+
+    /**
+     * @brief Views a buffer as a matrix.
+     * @param values Pointer to the first element.
+     * @param nrows Number of rows.
+     * @param ncols Number of columns.
+     * @param ld Distance between the starts of consecutive rows, at least the number of columns.
+     */
+    constexpr matrix_view(T* values, const std::size_t nrows, const std::size_t ncols,
+                          const std::size_t ld) noexcept
+        : data(values), rows(nrows), cols(ncols), stride(ld) {}
+
+    /**
+     * @brief Views a contiguous span as a matrix without padding.
+     * @param values Elements, at least rows * cols of them.
+     * @param nrows Number of rows.
+     * @param ncols Number of columns.
+     */
+    constexpr matrix_view(std::span<T> values, const std::size_t nrows,
+                          const std::size_t ncols) noexcept
+        : matrix_view(values.data(), nrows, ncols, ncols) {}
+
+    /**
+     * @brief Converts a mutable view into a read-only one.
+     * @param other View to convert.
+     */
+    template <typename U>
+        requires std::is_convertible_v<U (*)[], T (*)[]>
+    constexpr matrix_view(const matrix_view<U>& other) noexcept
+        : matrix_view(other.data, other.rows, other.cols, other.stride) {}
+
+    /**
+     * @brief Accesses a row.
+     * @param i Row index.
+     * @return Span over the row.
+     */
+    [[nodiscard]] constexpr auto row(const std::size_t i) const noexcept {
+        return std::span<T>(data + i * stride, cols);
+    }
+};
+
+}  // namespace fun
+
+#endif  // MATRIX_HPP
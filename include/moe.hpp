@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MOE_HPP
+#define MOE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+#include "constexpr_ops.hpp"
+#include "matrix.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+/**
+ * @brief Which logits the router weights are normalized over.
+ */
+enum class gating_softmax {
+    selected,  // Softmax over the k selected logits, the weights sum to one.
+    full       // Softmax over every expert, the weights are the selected probabilities.
+};
+
+namespace detail {
+
+/**
+ * @brief Selects the k largest values of a row, in descending order.
+ *
+ * Each value is inserted into a sorted run of at most k candidates, which stays in registers for
+ * the usual k of 1 to 8. Ties keep the lower index first.
+ *
+ * @param zs Router logits of one token.
+ * @param experts Indices of the selected experts, k of them, at most as many as the logits.
+ * @param values Selected logits, k of them.
+ */
+constexpr void select_top(std::span<const double> zs, std::span<std::size_t> experts,
+                          std::span<double> values) noexcept {
+    const auto k = experts.size();
+    if (k == 0) {
+        return;
+    }
+    std::size_t count = 0;
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        const auto z = zs[j];
+        if (count == k && !(z > values[k - 1])) {
+            continue;
+        }
+        auto pos = count < k ? count++ : k - 1;
+        for (; pos > 0 && values[pos - 1] < z; --pos) {
+            values[pos] = values[pos - 1];
+            experts[pos] = experts[pos - 1];
+        }
+        values[pos] = z;
+        experts[pos] = j;
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Fused top-k router of a mixture-of-experts layer.
+ *
+ * For every token, selects the k experts with the largest logits and writes their indices and
+ * gating weights in one pass over the logits, instead of a full softmax, a partial sort and a
+ * second normalization. A k larger than the number of experts selects all of them, and the
+ * slots past the number of experts get the index of no expert, that number itself, and a zero
+ * weight.
+ *
+ * @param logits Router logits, one row per token and one column per expert.
+ * @param experts Selected experts in descending order of logit, one row of k per token.
+ * @param weights Gating weights of the selected experts, one row of k per token.
+ * @param mode Whether the weights are normalized over the selected or over all experts.
+ */
+constexpr void topk_gating(matrix_view<const double> logits, matrix_view<std::size_t> experts,
+                           matrix_view<double> weights,
+                           const gating_softmax mode = gating_softmax::selected) noexcept {
+    const auto k = std::min(experts.cols, logits.cols);
+    for (std::size_t i = 0; i < logits.rows; ++i) {
+        const auto zs = logits.row(i);
+        const auto es = experts.row(i);
+        const auto ws = weights.row(i).first(k);
+        std::fill(es.begin() + static_cast<std::ptrdiff_t>(k), es.end(), logits.cols);
+        std::fill(weights.row(i).begin() + static_cast<std::ptrdiff_t>(k), weights.row(i).end(),
+                  0.0);
+        if (k == 0) {
+            continue;
+        }
+        detail::select_top(zs, es.first(k), ws);
+
+        // The largest selected logit is the maximum of the row as well.
+        auto acc = detail::online_sum{ws[0], 0.0};
+        if (mode == gating_softmax::full) {
+            acc = detail::reduce(zs);
+        } else {
+            for (const auto w : ws) {
+                acc.sum += constexpr_ops::exp(w - acc.max);
+            }
+        }
+        const auto inv = 1 / acc.sum;
+        for (auto& w : ws) {
+            w = constexpr_ops::exp(w - acc.max) * inv;
+        }
+    }
+}
+
+/**
+ * @brief Backward pass of the top-k router with respect to the logits.
+ *
+ * Only the gating weights are differentiable, the selection itself passes no gradient. With
+ * selected normalization only the k selected logits receive a gradient, with full normalization
+ * every logit does through the shared normalizer.
+ *
+ * @param logits Router logits of the forward pass.
+ * @param experts Selected experts of the forward pass.
+ * @param weights Gating weights of the forward pass.
+ * @param grad_weights Gradient with respect to the gating weights.
+ * @param grad_logits Gradient with respect to the logits.
+ * @param mode Normalization used in the forward pass.
+ */
+constexpr void topk_gating_backward(matrix_view<const double> logits,
+                                    matrix_view<const std::size_t> experts,
+                                    matrix_view<const double> weights,
+                                    matrix_view<const double> grad_weights,
+                                    matrix_view<double> grad_logits,
+                                    const gating_softmax mode = gating_softmax::selected) noexcept {
+    const auto k = std::min(experts.cols, logits.cols);
+    for (std::size_t i = 0; i < logits.rows; ++i) {
+        const auto idx = experts.row(i).first(k);
+        const auto ws = weights.row(i);
+        const auto gs = grad_weights.row(i);
+        const auto out = grad_logits.row(i);
+
+        auto dot = 0.0;
+        for (std::size_t s = 0; s < idx.size(); ++s) {
+            dot += ws[s] * gs[s];
+        }
+
+        if (mode == gating_softmax::full) {
+            // dL/dz_m = p_m (g(m) - sum_s w_s g_s), where g(m) is zero for unselected experts.
+            softmax(logits.row(i), out);
+            for (auto& g : out) {
+                g *= -dot;
+            }
+        } else {
+            std::fill(out.begin(), out.end(), 0.0);
+        }
+        for (std::size_t s = 0; s < idx.size(); ++s) {
+            out[idx[s]] += ws[s] * (mode == gating_softmax::full ? gs[s] : gs[s] - dot);
+        }
+    }
+}
+
+}  // namespace fun
+
+#endif  // MOE_HPP
@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace fun::parallel {
+
+/**
+ * @brief Whether results must be bitwise identical for any thread count and instruction set.
+ *
+ * Defining FUN_REPRODUCIBLE turns it on; the ENABLE_REPRODUCIBLE build option does so and also
+ * compiles with -ffp-contract=off, so that no instruction set fuses the multiply-adds of the
+ * polynomials differently from another. The single-row softmax, log_softmax and log_sum_exp
+ * then reduce along the same blocks and pairwise tree as reduce, so they match the parallel ones.
+ */
+#ifdef FUN_REPRODUCIBLE
+static const constexpr bool REPRODUCIBLE = true;
+#else
+static const constexpr bool REPRODUCIBLE = false;
+#endif
+
+/**
+ * @brief Default number of elements per block, enough work to amortize starting a thread.
+ */
+static const constexpr std::size_t GRAIN = 16384;
+
+/**
+ * @brief Number of threads worth starting for the given amount of work.
+ * @param blocks Number of independent blocks.
+ * @return Number of threads, at least one and at most one per block.
+ */
+[[nodiscard]] inline auto concurrency(const std::size_t blocks) noexcept {
+    const auto hardware = static_cast<std::size_t>(std::thread::hardware_concurrency());
+    return std::max<std::size_t>(1, std::min(blocks, hardware));
+}
+
+/**
+ * @brief Calls a function on every block of a range, spreading the blocks over threads.
+ *
+ * Each thread takes a contiguous run of blocks and the calling thread takes the last run, so
+ * small ranges never start a thread.
+ *
+ * @param n Number of elements.
+ * @param grain Number of elements per block, the last block may be shorter, zero being taken as
+ * one.
+ * @param f Function called as f(block, begin, end) for every block.
+ */
+template <typename F>
+void for_each_block(const std::size_t n, std::size_t grain, F&& f) {
+    grain = std::max<std::size_t>(grain, 1);
+    const auto blocks = (n + grain - 1) / grain;
+    const auto threads = concurrency(blocks);
+    const auto run = [&](const std::size_t first, const std::size_t last) {
+        for (auto b = first; b < last; ++b) {
+            f(b, b * grain, std::min(n, (b + 1) * grain));
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t t = 0; t + 1 < threads; ++t) {
+        workers.emplace_back(run, blocks * t / threads, blocks * (t + 1) / threads);
+    }
+    run(blocks * (threads - 1) / threads, blocks);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Combines per-block partial results computed in parallel.
+ *
+ * Once every thread has finished, the partials are combined along a fixed pairwise tree that
+ * only depends on the number of blocks, so the result depends on the grain but not on the number
+ * of threads, and rounding errors grow with the logarithm of the number of blocks.
+ *
+ * @param n Number of elements.
+ * @param f Function called as f(begin, end) returning the partial result of a block.
+ * @param combine Function called as combine(lhs, rhs) with lhs from the earlier blocks.
+ * @param grain Number of elements per block.
+ * @return Combined result, a value-initialized one for an empty range.
+ */
+template <typename F, typename C>
+[[nodiscard]] auto reduce(const std::size_t n, F&& f, C&& combine, std::size_t grain = GRAIN) {
+    grain = std::max<std::size_t>(grain, 1);
+    using T = std::decay_t<std::invoke_result_t<F&, std::size_t, std::size_t>>;
+    std::vector<T> partials((n + grain - 1) / grain);
+    for_each_block(n, grain, [&](const std::size_t block, const std::size_t begin,
+                                 const std::size_t end) { partials[block] = f(begin, end); });
+
+    for (std::size_t stride = 1; stride < partials.size(); stride *= 2) {
+        for (std::size_t i = 0; i + stride < partials.size(); i += 2 * stride) {
+            partials[i] = combine(partials[i], partials[i + stride]);
+        }
+    }
+    return partials.empty() ? T{} : partials.front();
+}
+
+/**
+ * @brief Sums per-block partial results computed in parallel, along the tree of reduce.
+ * @param n Number of elements.
+ * @param f Function called as f(begin, end) returning the partial sum of a block.
+ * @param grain Number of elements per block.
+ * @return Sum of the partials.
+ */
+template <typename F>
+[[nodiscard]] auto sum(const std::size_t n, F&& f, const std::size_t grain = GRAIN) {
+    return reduce(
+        n, f, [](const double lhs, const double rhs) { return lhs + rhs; }, grain);
+}
+
+}  // namespace fun::parallel
+
+#endif  // PARALLEL_HPP
@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PARALLEL_SOFTMAX_HPP
+#define PARALLEL_SOFTMAX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+#include "parallel.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+/**
+ * @brief How the partial results of a row split across threads are combined.
+ *
+ * Both modes merge the blocks along the pairwise tree of parallel::reduce. In reproducible builds
+ * the single-threaded softmax and log_softmax use the same tree over blocks of parallel::GRAIN,
+ * so their results are bitwise identical to the ones here at the default grain.
+ */
+enum class reduction {
+    fast,           // One block per thread, deterministic anyway in reproducible builds.
+    deterministic,  // Fixed-size blocks, identical for any thread count.
+};
+
+namespace detail {
+
+/**
+ * @brief Number of elements per block for a row split across threads.
+ * @param n Row length.
+ * @param grain Block size of the deterministic mode, zero being taken as one.
+ * @param mode Reduction mode.
+ * @return Block size.
+ */
+[[nodiscard]] inline auto row_grain(const std::size_t n, std::size_t grain,
+                                    const reduction mode) noexcept {
+    grain = std::max<std::size_t>(grain, 1);
+    if (mode == reduction::deterministic || parallel::REPRODUCIBLE) {
+        return grain;
+    }
+    const auto threads = parallel::concurrency((n + grain - 1) / grain);
+    return std::max(grain, (n + threads - 1) / threads);
+}
+
+/**
+ * @brief Reduces one row with every block reduced on its own thread.
+ *
+ * Each block yields its own maximum and the sum of its exponentials shifted by it; the partials
+ * are then merged along the tree of parallel::reduce, rescaling each sum to the larger maximum.
+ *
+ * @param zs Logits.
+ * @param grain Number of elements per block.
+ * @return Maximum and shifted sum of exponentials of the row.
+ */
+[[nodiscard]] inline auto parallel_reduce(std::span<const double> zs, const std::size_t grain) {
+    return parallel::reduce(
+        zs.size(),
+        [&](const std::size_t begin, const std::size_t end) {
+            return reduce(zs.subspan(begin, end - begin));
+        },
+        merge, grain);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Log-sum-exp of one row split across threads.
+ * @param zs Logits.
+ * @param mode Whether the result must not depend on the number of threads.
+ * @param grain Number of elements per block of the deterministic mode.
+ * @return log(sum(exp(z))), negative infinity for an empty row.
+ */
+[[nodiscard]] inline auto parallel_log_sum_exp(std::span<const double> zs,
+                                               const reduction mode = reduction::fast,
+                                               const std::size_t grain = parallel::GRAIN) {
+    return detail::log_sum(detail::parallel_reduce(zs, detail::row_grain(zs.size(), grain, mode)));
+}
+
+/**
+ * @brief Softmax of one row split across threads, for rows too wide for one core.
+ *
+ * A parallel reduction of partial maxima and rescaled partial sums is followed by a parallel
+ * normalization pass over the same blocks.
+ *
+ * @param zs Logits.
+ * @param out Output values, may alias the input.
+ * @param mode Whether the result must not depend on the number of threads.
+ * @param grain Number of elements per block of the deterministic mode.
+ */
+inline void parallel_softmax(std::span<const double> zs, std::span<double> out,
+                             const reduction mode = reduction::fast,
+                             const std::size_t grain = parallel::GRAIN) {
+    const auto block = detail::row_grain(zs.size(), grain, mode);
+    const auto acc = detail::parallel_reduce(zs, block);
+    parallel::for_each_block(
+        zs.size(), block, [&](const std::size_t, const std::size_t begin, const std::size_t end) {
+            detail::normalize(zs.subspan(begin, end - begin), out.subspan(begin), acc);
+        });
+}
+
+/**
+ * @brief Log-softmax of one row split across threads.
+ * @param zs Logits.
+ * @param out Output values, may alias the input.
+ * @param mode Whether the result must not depend on the number of threads.
+ * @param grain Number of elements per block of the deterministic mode.
+ */
+inline void parallel_log_softmax(std::span<const double> zs, std::span<double> out,
+                                 const reduction mode = reduction::fast,
+                                 const std::size_t grain = parallel::GRAIN) {
+    const auto block = detail::row_grain(zs.size(), grain, mode);
+    const auto acc = detail::parallel_reduce(zs, block);
+    parallel::for_each_block(
+        zs.size(), block, [&](const std::size_t, const std::size_t begin, const std::size_t end) {
+            detail::log_normalize(zs.subspan(begin, end - begin), out.subspan(begin), acc);
+        });
+}
+
+}  // namespace fun
+
+#endif  // PARALLEL_SOFTMAX_HPP
@@ -0,0 +1,215 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "batch.hpp"
+#include "fun.hpp"
+
+namespace fun {
+
+/**
+ * @brief Chain of elementwise stages assembled at runtime, e.g. from a model configuration.
+ *
+ * The chain is executed over blocks small enough to stay in L1: the first stage reads a block of
+ * the input into the output, and every later stage runs its own vectorized loop over that block
+ * while it is still cached. Intermediate values therefore never travel to memory, unlike running
+ * each stage as a separate pass.
+ *
+ * Operand spans are referenced, not copied, and must outlive the pipeline.
+ */
+class pipeline {
+   public:
+    /**
+     * @brief Number of elements per block, 8 KiB of doubles.
+     */
+    static const constexpr std::size_t BLOCK_SIZE = 1024;
+
+    /**
+     * @brief Appends the addition of a per-column bias, broadcast across rows.
+     * @param bias Values, one per column.
+     * @return The pipeline, for chaining.
+     */
+    pipeline& add_bias(std::span<const double> bias) {
+        stages_.push_back({op::add_bias, activation::id, 0, 0, bias});
+        return *this;
+    }
+
+    /**
+     * @brief Appends the elementwise addition of another tensor, e.g. a residual.
+     * @param other Values, one per element.
+     * @return The pipeline, for chaining.
+     */
+    pipeline& add(std::span<const double> other) {
+        stages_.push_back({op::add, activation::id, 0, 0, other});
+        return *this;
+    }
+
+    /**
+     * @brief Appends the elementwise multiplication by another tensor, e.g. a gate.
+     * @param other Values, one per element.
+     * @return The pipeline, for chaining.
+     */
+    pipeline& multiply(std::span<const double> other) {
+        stages_.push_back({op::multiply, activation::id, 0, 0, other});
+        return *this;
+    }
+
+    /**
+     * @brief Appends the multiplication by a scalar.
+     * @param factor Scale factor.
+     * @return The pipeline, for chaining.
+     */
+    pipeline& scale(const double factor) {
+        stages_.push_back({op::scale, activation::id, factor, 0, {}});
+        return *this;
+    }
+
+    /**
+     * @brief Appends clamping to an interval.
+     * @param lo Lower bound.
+     * @param hi Upper bound.
+     * @return The pipeline, for chaining.
+     */
+    pipeline& clamp(const double lo, const double hi) {
+        stages_.push_back({op::clamp, activation::id, lo, hi, {}});
+        return *this;
+    }
+
+    /**
+     * @brief Appends an activation function.
+     * @param kind Activation function.
+     * @param param Parameter of parametric activations, ignored by the others.
+     * @return The pipeline, for chaining.
+     */
+    pipeline& activate(const activation kind, const double param = 0) {
+        stages_.push_back({op::activate, kind, param, 0, {}});
+        return *this;
+    }
+
+    /**
+     * @brief Runs the pipeline over a row-major matrix.
+     * @param in Input values.
+     * @param out Output values, same size as the input, may alias it.
+     * @param cols Number of columns, which biases are indexed by. A trailing partial row is
+     * biased by its leading columns, and zero columns leave the output untouched.
+     */
+    void run(std::span<const double> in, std::span<double> out, const std::size_t cols) const {
+        if (cols == 0) {
+            return;
+        }
+        if (stages_.empty()) {
+            batch::detail::copy(in, out);
+            return;
+        }
+        for (std::size_t i = 0; i < in.size(); i += BLOCK_SIZE) {
+            const auto n = std::min(BLOCK_SIZE, in.size() - i);
+            auto block = out.subspan(i, n);
+            // The first stage loads the block, all later ones work on it in place.
+            run_stage(stages_.front(), in.subspan(i, n), block, i, cols);
+            for (auto it = stages_.begin() + 1; it != stages_.end(); ++it) {
+                run_stage(*it, block, block, i, cols);
+            }
+        }
+    }
+
+    /**
+     * @brief Runs the pipeline over a vector.
+     * @param in Input values.
+     * @param out Output values, same size as the input, may alias it.
+     */
+    void run(std::span<const double> in, std::span<double> out) const {
+        run(in, out, in.size());
+    }
+
+   private:
+    enum class op { add_bias, add, multiply, scale, clamp, activate };
+
+    struct stage {
+        op kind;
+        activation act;
+        double a;
+        double b;
+        std::span<const double> operand;
+    };
+
+    /**
+     * @brief Runs one stage over a block.
+     * @param s Stage.
+     * @param src Block of input values.
+     * @param dst Block of output values, may alias the input block.
+     * @param offset Flat index of the first element of the block.
+     * @param cols Number of columns.
+     */
+    static void run_stage(const stage& s, std::span<const double> src, std::span<double> dst,
+                          const std::size_t offset, const std::size_t cols) noexcept {
+        switch (s.kind) {
+            case op::add_bias:
+                // Split the block at row boundaries so the inner loop has no modulo.
+                for (std::size_t j = 0, col = offset % cols; j < src.size(); col = 0) {
+                    const auto len = std::min(src.size() - j, cols - col);
+                    for (std::size_t k = 0; k < len; ++k) {
+                        dst[j + k] = src[j + k] + s.operand[col + k];
+                    }
+                    j += len;
+                }
+                break;
+            case op::add:
+                for (std::size_t j = 0; j < src.size(); ++j) {
+                    dst[j] = src[j] + s.operand[offset + j];
+                }
+                break;
+            case op::multiply:
+                for (std::size_t j = 0; j < src.size(); ++j) {
+                    dst[j] = src[j] * s.operand[offset + j];
+                }
+                break;
+            case op::scale:
+                for (std::size_t j = 0; j < src.size(); ++j) {
+                    dst[j] = src[j] * s.a;
+                }
+                break;
+            case op::clamp:
+                for (std::size_t j = 0; j < src.size(); ++j) {
+                    dst[j] = std::min(std::max(src[j], s.a), s.b);
+                }
+                break;
+            case op::activate:
+                batch::activate(s.act, src, dst, s.a);
+                break;
+        }
+    }
+
+    std::vector<stage> stages_;
+};
+
+}  // namespace fun
+
+#endif  // PIPELINE_HPP
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace fun {
+
+namespace detail {
+
+/**
+ * @brief Multipliers and key increments of Philox4x32, from Salmon et al., "Parallel random
+ * numbers: as easy as 1, 2, 3", SC 2011.
+ */
+static const constexpr std::uint64_t PHILOX_M0 = 0xD2511F53;
+static const constexpr std::uint64_t PHILOX_M1 = 0xCD9E8D57;
+static const constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9;
+static const constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85;
+
+}  // namespace detail
+
+/**
+ * @brief Philox4x32-10 counter-based generator.
+ *
+ * The output is a pure function of the counter and the key, so any element of a random stream
+ * can be generated independently of the others: in parallel, out of order, or again on replay.
+ *
+ * @param counter Position in the stream.
+ * @param key Stream selector, usually a seed.
+ * @return Four independent 32-bit random words.
+ */
+[[nodiscard]] constexpr auto philox(std::array<std::uint32_t, 4> counter,
+                                    std::array<std::uint32_t, 2> key) noexcept {
+    for (int round = 0; round < 10; ++round) {
+        const auto p0 = detail::PHILOX_M0 * counter[0];
+        const auto p1 = detail::PHILOX_M1 * counter[2];
+        counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key[0],
+                   static_cast<std::uint32_t>(p1),
+                   static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key[1],
+                   static_cast<std::uint32_t>(p0)};
+        key[0] += detail::PHILOX_W0;
+        key[1] += detail::PHILOX_W1;
+    }
+    return counter;
+}
+
+/**
+ * @brief Uniform random number in [0, 1) at a position of a seeded stream.
+ * @param seed Seed selecting the stream.
+ * @param counter Position in the stream, such as a step or an element index.
+ * @param lane Independent substream, such as a tensor or a purpose within the same step.
+ * @return Random double with 53 random bits.
+ */
+[[nodiscard]] constexpr auto uniform(const std::uint64_t seed, const std::uint64_t counter,
+                                     const std::uint64_t lane = 0) noexcept {
+    const auto words = philox({static_cast<std::uint32_t>(counter),
+                               static_cast<std::uint32_t>(counter >> 32),
+                               static_cast<std::uint32_t>(lane),
+                               static_cast<std::uint32_t>(lane >> 32)},
+                              {static_cast<std::uint32_t>(seed),
+                               static_cast<std::uint32_t>(seed >> 32)});
+    const auto bits = (static_cast<std::uint64_t>(words[0]) << 32) | words[1];
+    return static_cast<double>(bits >> 11) * 0x1p-53;
+}
+
+}  // namespace fun
+
+#endif  // RANDOM_HPP
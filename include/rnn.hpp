@@ -0,0 +1,239 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RNN_HPP
+#define RNN_HPP
+
+#include <cstddef>
+#include <span>
+
+#include "fun.hpp"
+#include "matrix.hpp"
+
+namespace fun {
+
+namespace detail {
+
+/**
+ * @brief Branch-free tanh via 2 σ(2x) - 1, absolutely accurate to a few ulps of one, which is
+ * what recurrent states need and keeps the cell loops vectorizable.
+ * @param x Input value.
+ * @return tanh of the input value.
+ */
+[[nodiscard]] constexpr auto cell_tanh(const double x) noexcept {
+    return 2 * fun::sigmoid(2 * x) - 1;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Fused LSTM cell over one sample, the batch size 1 case of streaming inference.
+ * @param gates Pre-activations of the input, forget, cell and output gates, 4H values.
+ * @param c_prev Previous cell state, H values.
+ * @param c New cell state, H values, may alias the previous one.
+ * @param h New hidden state, H values.
+ */
+constexpr void lstm_cell(std::span<const double> gates, std::span<const double> c_prev,
+                         std::span<double> c, std::span<double> h) noexcept {
+    const auto n = c.size();
+    for (std::size_t j = 0; j < n; ++j) {
+        const auto i = fun::sigmoid(gates[j]);
+        const auto f = fun::sigmoid(gates[n + j]);
+        const auto g = detail::cell_tanh(gates[2 * n + j]);
+        const auto o = fun::sigmoid(gates[3 * n + j]);
+        const auto cell = f * c_prev[j] + i * g;
+        c[j] = cell;
+        h[j] = o * detail::cell_tanh(cell);
+    }
+}
+
+/**
+ * @brief Fused LSTM cell backward pass over one sample.
+ * @param gates Pre-activations of the forward pass, 4H values.
+ * @param c_prev Previous cell state of the forward pass, H values.
+ * @param grad_h Gradient with respect to the new hidden state, H values.
+ * @param grad_c Gradient with respect to the new cell state from the next timestep, H values.
+ * @param grad_gates Gradient with respect to the pre-activations, 4H values.
+ * @param grad_c_prev Gradient with respect to the previous cell state, H values, may alias
+ * grad_c.
+ */
+constexpr void lstm_cell_backward(std::span<const double> gates, std::span<const double> c_prev,
+                                  std::span<const double> grad_h, std::span<const double> grad_c,
+                                  std::span<double> grad_gates,
+                                  std::span<double> grad_c_prev) noexcept {
+    const auto n = grad_h.size();
+    for (std::size_t j = 0; j < n; ++j) {
+        const auto i = fun::sigmoid(gates[j]);
+        const auto f = fun::sigmoid(gates[n + j]);
+        const auto g = detail::cell_tanh(gates[2 * n + j]);
+        const auto o = fun::sigmoid(gates[3 * n + j]);
+        const auto tc = detail::cell_tanh(f * c_prev[j] + i * g);
+        const auto dc = grad_c[j] + grad_h[j] * o * (1 - tc * tc);
+        grad_gates[j] = dc * g * i * (1 - i);
+        grad_gates[n + j] = dc * c_prev[j] * f * (1 - f);
+        grad_gates[2 * n + j] = dc * i * (1 - g * g);
+        grad_gates[3 * n + j] = grad_h[j] * tc * o * (1 - o);
+        grad_c_prev[j] = dc * f;
+    }
+}
+
+/**
+ * @brief Fused GRU cell over one sample.
+ * @param gates_x Input-side pre-activations of the reset, update and new gates, 3H values.
+ * @param gates_h Hidden-side pre-activations of the reset, update and new gates, 3H values.
+ * @param h_prev Previous hidden state, H values.
+ * @param h New hidden state, H values, may alias the previous one.
+ */
+constexpr void gru_cell(std::span<const double> gates_x, std::span<const double> gates_h,
+                        std::span<const double> h_prev, std::span<double> h) noexcept {
+    const auto n = h.size();
+    for (std::size_t j = 0; j < n; ++j) {
+        const auto r = fun::sigmoid(gates_x[j] + gates_h[j]);
+        const auto z = fun::sigmoid(gates_x[n + j] + gates_h[n + j]);
+        const auto cand = detail::cell_tanh(gates_x[2 * n + j] + r * gates_h[2 * n + j]);
+        h[j] = (1 - z) * cand + z * h_prev[j];
+    }
+}
+
+/**
+ * @brief Fused GRU cell backward pass over one sample.
+ * @param gates_x Input-side pre-activations of the forward pass, 3H values.
+ * @param gates_h Hidden-side pre-activations of the forward pass, 3H values.
+ * @param h_prev Previous hidden state of the forward pass, H values.
+ * @param grad_h Gradient with respect to the new hidden state, H values.
+ * @param grad_gates_x Gradient with respect to the input-side pre-activations, 3H values.
+ * @param grad_gates_h Gradient with respect to the hidden-side pre-activations, 3H values.
+ * @param grad_h_prev Direct gradient with respect to the previous hidden state, H values,
+ * excluding the path through the hidden-side projection.
+ */
+constexpr void gru_cell_backward(std::span<const double> gates_x, std::span<const double> gates_h,
+                                 std::span<const double> h_prev, std::span<const double> grad_h,
+                                 std::span<double> grad_gates_x, std::span<double> grad_gates_h,
+                                 std::span<double> grad_h_prev) noexcept {
+    const auto n = grad_h.size();
+    for (std::size_t j = 0; j < n; ++j) {
+        const auto r = fun::sigmoid(gates_x[j] + gates_h[j]);
+        const auto z = fun::sigmoid(gates_x[n + j] + gates_h[n + j]);
+        const auto cand = detail::cell_tanh(gates_x[2 * n + j] + r * gates_h[2 * n + j]);
+        const auto dh = grad_h[j];
+        const auto dcand = dh * (1 - z) * (1 - cand * cand);
+        const auto dr = dcand * gates_h[2 * n + j] * r * (1 - r);
+        const auto dz = dh * (h_prev[j] - cand) * z * (1 - z);
+        grad_gates_x[j] = dr;
+        grad_gates_h[j] = dr;
+        grad_gates_x[n + j] = dz;
+        grad_gates_h[n + j] = dz;
+        grad_gates_x[2 * n + j] = dcand;
+        grad_gates_h[2 * n + j] = dcand * r;
+        grad_h_prev[j] = dh * z;
+    }
+}
+
+/**
+ * @brief Fused LSTM cell: activates the four gate blocks and updates the cell and hidden states
+ * of every sample in one pass.
+ *
+ * The gate order is input, forget, cell, output, each block H wide, as in PyTorch.
+ *
+ * @param gates Pre-activations, one row of 4H values per sample.
+ * @param c_prev Previous cell states, one row of H values per sample.
+ * @param c New cell states, may alias the previous ones.
+ * @param h New hidden states.
+ */
+constexpr void lstm_cell(matrix_view<const double> gates, matrix_view<const double> c_prev,
+                         matrix_view<double> c, matrix_view<double> h) noexcept {
+    for (std::size_t i = 0; i < gates.rows; ++i) {
+        lstm_cell(gates.row(i), c_prev.row(i), c.row(i), h.row(i));
+    }
+}
+
+/**
+ * @brief Fused LSTM cell backward pass, recomputing the gate activations from the
+ * pre-activations instead of storing them.
+ * @param gates Pre-activations of the forward pass, one row of 4H values per sample.
+ * @param c_prev Previous cell states of the forward pass.
+ * @param grad_h Gradients with respect to the new hidden states.
+ * @param grad_c Gradients with respect to the new cell states from the next timestep, zero at
+ * the last one.
+ * @param grad_gates Gradients with respect to the pre-activations.
+ * @param grad_c_prev Gradients with respect to the previous cell states, may alias grad_c.
+ */
+constexpr void lstm_cell_backward(matrix_view<const double> gates, matrix_view<const double> c_prev,
+                                  matrix_view<const double> grad_h,
+                                  matrix_view<const double> grad_c,
+                                  matrix_view<double> grad_gates,
+                                  matrix_view<double> grad_c_prev) noexcept {
+    for (std::size_t i = 0; i < gates.rows; ++i) {
+        lstm_cell_backward(gates.row(i), c_prev.row(i), grad_h.row(i), grad_c.row(i),
+                           grad_gates.row(i), grad_c_prev.row(i));
+    }
+}
+
+/**
+ * @brief Fused GRU cell: activates the three gate blocks and updates the hidden state of every
+ * sample in one pass.
+ *
+ * The gate order is reset, update, new, each block H wide, as in PyTorch. The input-side and
+ * hidden-side projections are passed separately because the reset gate only scales the
+ * hidden-side part of the new gate.
+ *
+ * @param gates_x Input-side pre-activations, one row of 3H values per sample.
+ * @param gates_h Hidden-side pre-activations, one row of 3H values per sample.
+ * @param h_prev Previous hidden states.
+ * @param h New hidden states, may alias the previous ones.
+ */
+constexpr void gru_cell(matrix_view<const double> gates_x, matrix_view<const double> gates_h,
+                        matrix_view<const double> h_prev, matrix_view<double> h) noexcept {
+    for (std::size_t i = 0; i < gates_x.rows; ++i) {
+        gru_cell(gates_x.row(i), gates_h.row(i), h_prev.row(i), h.row(i));
+    }
+}
+
+/**
+ * @brief Fused GRU cell backward pass, recomputing the gate activations from the
+ * pre-activations instead of storing them.
+ * @param gates_x Input-side pre-activations of the forward pass.
+ * @param gates_h Hidden-side pre-activations of the forward pass.
+ * @param h_prev Previous hidden states of the forward pass.
+ * @param grad_h Gradients with respect to the new hidden states.
+ * @param grad_gates_x Gradients with respect to the input-side pre-activations.
+ * @param grad_gates_h Gradients with respect to the hidden-side pre-activations.
+ * @param grad_h_prev Direct gradients with respect to the previous hidden states, excluding the
+ * path through the hidden-side projection.
+ */
+constexpr void gru_cell_backward(matrix_view<const double> gates_x,
+                                 matrix_view<const double> gates_h,
+                                 matrix_view<const double> h_prev,
+                                 matrix_view<const double> grad_h,
+                                 matrix_view<double> grad_gates_x, matrix_view<double> grad_gates_h,
+                                 matrix_view<double> grad_h_prev) noexcept {
+    for (std::size_t i = 0; i < gates_x.rows; ++i) {
+        gru_cell_backward(gates_x.row(i), gates_h.row(i), h_prev.row(i), grad_h.row(i),
+                          grad_gates_x.row(i), grad_gates_h.row(i), grad_h_prev.row(i));
+    }
+}
+
+}  // namespace fun
+
+#endif  // RNN_HPP
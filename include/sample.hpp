@@ -0,0 +1,255 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SAMPLE_HPP
+#define SAMPLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "constexpr_ops.hpp"
+#include "random.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+/**
+ * @brief Decoding parameters of token sampling.
+ */
+struct sampling {
+    double temperature = 1;  // Divides the logits, zero selects the most likely token.
+    std::size_t top_k = 0;   // Keeps the k most likely tokens, zero keeps all of them.
+    double top_p = 1;        // Keeps the smallest set of tokens holding this probability mass.
+    std::uint64_t seed = 0;  // Seed of the counter-based generator.
+};
+
+namespace detail {
+
+/**
+ * @brief Token kept by the sampling filters, with its unnormalized probability.
+ */
+struct candidate {
+    double weight;
+    std::size_t token;
+};
+
+/**
+ * @brief Computes the index of the largest logit, the lowest index on ties.
+ * @param logits Logits.
+ * @return Index of the largest logit.
+ */
+[[nodiscard]] constexpr auto argmax(std::span<const double> logits) noexcept {
+    std::size_t res = 0;
+    for (std::size_t j = 1; j < logits.size(); ++j) {
+        res = logits[j] > logits[res] ? j : res;
+    }
+    return res;
+}
+
+/**
+ * @brief Selects the k largest logits with a min-heap, one comparison per logit for the tokens
+ * that do not make it.
+ * @param logits Logits.
+ * @param k Number of tokens to keep, less than the number of logits.
+ * @return The selected logits and their tokens.
+ */
+[[nodiscard]] inline auto top_logits(std::span<const double> logits, const std::size_t k) {
+    const auto greater = [](const candidate& lhs, const candidate& rhs) {
+        return lhs.weight > rhs.weight;
+    };
+    std::vector<candidate> res;
+    res.reserve(k);
+    for (std::size_t j = 0; j < logits.size(); ++j) {
+        if (res.size() < k) {
+            res.push_back({logits[j], j});
+            std::push_heap(res.begin(), res.end(), greater);
+        } else if (logits[j] > res.front().weight) {
+            std::pop_heap(res.begin(), res.end(), greater);
+            res.back() = {logits[j], j};
+            std::push_heap(res.begin(), res.end(), greater);
+        }
+    }
+    return res;
+}
+
+/**
+ * @brief Keeps the shortest run of candidates, by decreasing weight, that reaches a mass.
+ * @param cs Candidates, of which the first ones are kept unconditionally and the others are
+ * sorted, always keeping at least one candidate.
+ * @param first Number of leading candidates kept unconditionally.
+ * @param target Mass to reach.
+ * @return Mass of the kept candidates.
+ */
+inline auto keep_prefix(std::vector<candidate>& cs, const std::size_t first, const double target) {
+    auto kept = 0.0;
+    for (std::size_t i = 0; i < first; ++i) {
+        kept += cs[i].weight;
+    }
+    const auto tail = cs.begin() + static_cast<std::ptrdiff_t>(first);
+    std::sort(tail, cs.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.weight > rhs.weight || (lhs.weight == rhs.weight && lhs.token < rhs.token);
+    });
+    auto keep = first;
+    while (keep < cs.size() && (keep == 0 || kept < target)) {
+        kept += cs[keep++].weight;
+    }
+    cs.resize(keep);
+    return kept;
+}
+
+/**
+ * @brief Number of probability bins of the nucleus search per halving of the probability.
+ */
+static const constexpr std::size_t NUCLEUS_BINS_PER_OCTAVE = 8;
+
+/**
+ * @brief Number of probability bins of the nucleus search, down to the underflow of the weights.
+ */
+static const constexpr std::size_t NUCLEUS_BINS = 1076 * NUCLEUS_BINS_PER_OCTAVE;
+
+/**
+ * @brief Collects the smallest set of most likely tokens holding a given fraction of the
+ * probability mass, without sorting the vocabulary.
+ *
+ * One pass builds a histogram of the mass per eighth of a power of two of probability, which
+ * locates the bin where the nucleus ends. A second pass gathers the tokens of the bins above it,
+ * which all belong to the nucleus, and of that bin, which alone is sorted to find the exact
+ * boundary.
+ *
+ * @param logits Logits.
+ * @param max Largest logit.
+ * @param inv_temp Inverse temperature.
+ * @param top_p Fraction of the mass to keep.
+ * @param mass Set to the unnormalized mass of the kept tokens.
+ * @return Tokens of the nucleus and their weights, in no particular order.
+ */
+[[nodiscard]] inline auto nucleus(std::span<const double> logits, const double max,
+                                  const double inv_temp, const double top_p, double& mass) {
+    const auto bin = [&](const double z) {
+        const auto pos = (max - z) * inv_temp * (NUCLEUS_BINS_PER_OCTAVE / constexpr_ops::LN2);
+        return pos < NUCLEUS_BINS - 1 ? static_cast<std::size_t>(pos) : NUCLEUS_BINS - 1;
+    };
+
+    std::vector<double> bins(NUCLEUS_BINS);
+    for (const auto z : logits) {
+        bins[bin(z)] += constexpr_ops::exp((z - max) * inv_temp);
+    }
+    auto total = 0.0;
+    for (const auto b : bins) {
+        total += b;
+    }
+
+    const auto target = top_p * total;
+    std::size_t last = 0;
+    for (auto acc = bins[0]; acc < target && last + 1 < NUCLEUS_BINS;) {
+        acc += bins[++last];
+    }
+
+    std::vector<candidate> res;
+    std::vector<candidate> boundary;
+    for (std::size_t j = 0; j < logits.size(); ++j) {
+        const auto b = bin(logits[j]);
+        if (b <= last) {
+            const auto c = candidate{constexpr_ops::exp((logits[j] - max) * inv_temp), j};
+            (b < last ? res : boundary).push_back(c);
+        }
+    }
+    const auto first = res.size();
+    res.insert(res.end(), boundary.begin(), boundary.end());
+    mass = keep_prefix(res, first, target);
+    return res;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Draws a token from logits with temperature, top-k and nucleus (top-p) filtering.
+ *
+ * The logits are never normalized or sorted as a whole: top-k keeps a heap of k tokens and top-p
+ * locates its boundary from a histogram, so only a few survivors are sorted, and they are
+ * normalized once by the draw. The random number is a function of the seed and the step, so a
+ * generation replays exactly.
+ *
+ * @param logits Logits over the vocabulary, not modified.
+ * @param config Temperature, filters and seed.
+ * @param step Position of the token in the generation, the counter of the generator.
+ * @return Index of the sampled token.
+ */
+[[nodiscard]] inline auto sample(std::span<const double> logits, const sampling& config,
+                                 const std::uint64_t step) {
+    const auto n = logits.size();
+    if (config.temperature == 0 || config.top_k == 1) {
+        return detail::argmax(logits);
+    }
+    const auto inv_temp = 1 / config.temperature;
+    const auto max = detail::max_of(logits);
+    const auto weight = [&](const double z) { return constexpr_ops::exp((z - max) * inv_temp); };
+
+    std::vector<detail::candidate> survivors;
+    auto mass = 0.0;
+    if (config.top_k != 0 && config.top_k < n) {
+        // Top-p then applies to the mass left by top-k.
+        survivors = detail::top_logits(logits, config.top_k);
+        for (auto& c : survivors) {
+            c.weight = weight(c.weight);
+            mass += c.weight;
+        }
+        if (config.top_p < 1) {
+            mass = detail::keep_prefix(survivors, 0, config.top_p * mass);
+        }
+    } else if (config.top_p < 1) {
+        survivors = detail::nucleus(logits, max, inv_temp, config.top_p, mass);
+    } else {
+        // Unfiltered: inverse transform over the whole vocabulary in a second pass.
+        for (const auto z : logits) {
+            mass += weight(z);
+        }
+        const auto u = uniform(config.seed, step) * mass;
+        auto acc = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            acc += weight(logits[j]);
+            if (u < acc) {
+                return j;
+            }
+        }
+        return detail::argmax(logits);
+    }
+
+    const auto u = uniform(config.seed, step) * mass;
+    auto acc = 0.0;
+    for (const auto& c : survivors) {
+        acc += c.weight;
+        if (u < acc) {
+            return c.token;
+        }
+    }
+    return survivors.back().token;
+}
+
+}  // namespace fun
+
+#endif  // SAMPLE_HPP
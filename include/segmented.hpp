@@ -0,0 +1,167 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SEGMENTED_HPP
+#define SEGMENTED_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "parallel.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+namespace detail {
+
+/**
+ * @brief Normalizes one segment, into probabilities or log-probabilities.
+ * @tparam Log Whether to write log-probabilities.
+ * @param zs Values of the segment.
+ * @param out Output values of the segment.
+ * @param acc Maximum and sum of the whole segment.
+ */
+template <bool Log>
+constexpr void finish(std::span<const double> zs, std::span<double> out,
+                      const online_sum& acc) noexcept {
+    if constexpr (Log) {
+        log_normalize(zs, out, acc);
+    } else {
+        normalize(zs, out, acc);
+    }
+}
+
+/**
+ * @brief Segmented softmax balanced over the number of elements rather than of segments.
+ *
+ * The values are split into blocks of grain elements and every block handles the segments
+ * starting inside it, so a thread gets about the same amount of work whatever the distribution
+ * of segment lengths. Segments longer than a block would still serialize a thread, so each of
+ * them is instead reduced and normalized block by block on all threads.
+ *
+ * @tparam Log Whether to write log-probabilities.
+ * @param zs Values of all segments, back to back.
+ * @param offsets Start of each segment, followed by the total number of values.
+ * @param out Output values, may alias the input.
+ * @param grain Number of elements per block, zero being taken as one.
+ */
+template <bool Log>
+void segmented(std::span<const double> zs, std::span<const std::size_t> offsets,
+               std::span<double> out, std::size_t grain) {
+    if (offsets.size() < 2) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    const auto segments = offsets.size() - 1;
+    const auto length = [&](const std::size_t s) { return offsets[s + 1] - offsets[s]; };
+    const auto values = [&](const std::size_t s) { return zs.subspan(offsets[s], length(s)); };
+    const auto outputs = [&](const std::size_t s) { return out.subspan(offsets[s], length(s)); };
+
+    const auto base = offsets.front();
+    parallel::for_each_block(
+        offsets.back() - base, grain,
+        [&](const std::size_t, const std::size_t begin, const std::size_t end) {
+            auto s = static_cast<std::size_t>(
+                std::lower_bound(offsets.begin(), offsets.end() - 1, base + begin) -
+                offsets.begin());
+            for (; s < segments && offsets[s] < base + end; ++s) {
+                if (length(s) <= grain) {
+                    finish<Log>(values(s), outputs(s), reduce(values(s)));
+                }
+            }
+        });
+
+    for (std::size_t s = 0; s < segments; ++s) {
+        if (length(s) <= grain) {
+            continue;
+        }
+        const auto seg = values(s);
+        const auto acc = parallel::reduce(
+            seg.size(),
+            [&](const std::size_t begin, const std::size_t end) {
+                return reduce(seg.subspan(begin, end - begin));
+            },
+            merge, grain);
+        parallel::for_each_block(
+            seg.size(), grain,
+            [&](const std::size_t, const std::size_t begin, const std::size_t end) {
+                finish<Log>(seg.subspan(begin, end - begin),
+                            outputs(s).subspan(begin, end - begin), acc);
+            });
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Converts sorted segment ids into segment offsets.
+ * @param ids Segment id of each value, non-decreasing and less than the number of segments.
+ * @param segments Number of segments, including empty ones.
+ * @return Start of each segment, followed by the number of values.
+ */
+[[nodiscard]] inline auto segment_offsets(std::span<const std::size_t> ids,
+                                          const std::size_t segments) {
+    std::vector<std::size_t> res(segments + 1);
+    for (std::size_t s = 0; s <= segments; ++s) {
+        res[s] = static_cast<std::size_t>(std::lower_bound(ids.begin(), ids.end(), s) -
+                                          ids.begin());
+    }
+    return res;
+}
+
+/**
+ * @brief Softmax over every segment of a ragged array, such as the incoming edges of each node
+ * of a graph stored in CSR form.
+ *
+ * All segments are normalized in one parallel pass without allocating per segment; empty
+ * segments are skipped and segments of negative infinities yield zeros.
+ *
+ * @param zs Values of all segments, back to back.
+ * @param offsets Start of each segment, followed by the total number of values.
+ * @param out Output values, may alias the input.
+ * @param grain Number of elements per unit of parallel work.
+ */
+inline void segmented_softmax(std::span<const double> zs, std::span<const std::size_t> offsets,
+                              std::span<double> out, const std::size_t grain = parallel::GRAIN) {
+    detail::segmented<false>(zs, offsets, out, grain);
+}
+
+/**
+ * @brief Log-softmax over every segment of a ragged array.
+ * @param zs Values of all segments, back to back.
+ * @param offsets Start of each segment, followed by the total number of values.
+ * @param out Output values, may alias the input.
+ * @param grain Number of elements per unit of parallel work.
+ */
+inline void segmented_log_softmax(std::span<const double> zs,
+                                  std::span<const std::size_t> offsets, std::span<double> out,
+                                  const std::size_t grain = parallel::GRAIN) {
+    detail::segmented<true>(zs, offsets, out, grain);
+}
+
+}  // namespace fun
+
+#endif  // SEGMENTED_HPP
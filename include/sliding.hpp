@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SLIDING_HPP
+#define SLIDING_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "constexpr_ops.hpp"
+#include "softmax.hpp"
+
+namespace fun {
+
+/**
+ * @brief Log-sum-exp and softmax over the last observations of a stream.
+ *
+ * A two-stack queue of online_sum aggregates: new values fold into a running aggregate of the
+ * back stack, and when the front stack runs out the back stack is flipped into it as suffix
+ * aggregates. Each value is thus pushed, flipped and popped once, for amortized O(1) per tick.
+ * Aggregates are only ever merged, never subtracted, so the result stays as accurate as a fresh
+ * log-sum-exp of the window however long the stream runs.
+ */
+class sliding_softmax {
+   public:
+    /**
+     * @brief Creates an empty window.
+     * @param window Number of most recent values kept, at least one.
+     */
+    explicit sliding_softmax(const std::size_t window) : capacity_(window) {
+        back_.reserve(window);
+        front_.reserve(window);
+    }
+
+    /**
+     * @brief Number of values currently in the window.
+     */
+    [[nodiscard]] auto size() const noexcept {
+        return front_.size() + back_.size();
+    }
+
+    /**
+     * @brief Appends a value, evicting the oldest one once the window is full.
+     * @param z New value.
+     */
+    void push(const double z) {
+        if (size() == capacity_) {
+            if (front_.empty()) {
+                flip();
+            }
+            front_.pop_back();
+        }
+        back_.push_back(z);
+        back_sum_ = detail::merge(back_sum_, detail::online_sum{z, 1});
+    }
+
+    /**
+     * @brief Log-sum-exp of the window, negative infinity when it is empty.
+     */
+    [[nodiscard]] auto log_sum_exp() const noexcept {
+        const auto acc = front_.empty() ? back_sum_ : detail::merge(front_.back(), back_sum_);
+        return detail::log_sum(acc);
+    }
+
+    /**
+     * @brief Log-probability of the newest value under the softmax of the window.
+     */
+    [[nodiscard]] auto newest_log_probability() const noexcept {
+        return back_.back() - log_sum_exp();
+    }
+
+    /**
+     * @brief Probability of the newest value under the softmax of the window.
+     */
+    [[nodiscard]] auto newest_probability() const noexcept {
+        return constexpr_ops::exp(newest_log_probability());
+    }
+
+   private:
+    /**
+     * @brief Moves the back stack into the front one, oldest value on top.
+     */
+    void flip() {
+        detail::online_sum acc;
+        for (auto it = back_.rbegin(); it != back_.rend(); ++it) {
+            acc = detail::merge(detail::online_sum{*it, 1}, acc);
+            front_.push_back(acc);
+        }
+        back_.clear();
+        back_sum_ = detail::online_sum{};
+    }
+
+    std::size_t capacity_;
+    std::vector<double> back_;
+    detail::online_sum back_sum_;
+    std::vector<detail::online_sum> front_;
+};
+
+/**
+ * @brief Log-sum-exp of every window of a series.
+ * @param zs Series of values.
+ * @param window Number of most recent values in each window, at least one.
+ * @param out Log-sum-exp of the window ending at each value.
+ */
+inline void sliding_log_sum_exp(std::span<const double> zs, const std::size_t window,
+                                std::span<double> out) {
+    sliding_softmax state(window);
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        state.push(zs[j]);
+        out[j] = state.log_sum_exp();
+    }
+}
+
+}  // namespace fun
+
+#endif  // SLIDING_HPP
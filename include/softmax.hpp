@@ -0,0 +1,617 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOFTMAX_HPP
+#define SOFTMAX_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "constexpr_ops.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+
+namespace fun {
+
+/**
+ * @brief Number of logits of a row reduced together, small enough that a chunk stays in the L1
+ * cache between its maximum and its sum of exponentials.
+ */
+static const constexpr std::size_t SOFTMAX_CHUNK = 2048;
+
+/**
+ * @brief Number of rows normalized side by side by the small-row kernel, one per SIMD lane of
+ * the widest vectors.
+ */
+static const constexpr std::size_t SOFTMAX_LANES = 8;
+
+/**
+ * @brief Widest row handled by the small-row kernel, wider rows are reduced one at a time.
+ */
+static const constexpr std::size_t SOFTMAX_SMALL_WIDTH = 64;
+
+namespace detail {
+
+/**
+ * @brief Running maximum of a row and the sum of its exponentials shifted by that maximum.
+ */
+struct online_sum {
+    double max = -std::numeric_limits<double>::infinity();
+    double sum = 0;
+};
+
+/**
+ * @brief Computes the maximum of the given values.
+ * @param zs Input values.
+ * @return The maximum, negative infinity for an empty input.
+ */
+[[nodiscard]] constexpr auto max_of(std::span<const double> zs) noexcept {
+    auto res = -std::numeric_limits<double>::infinity();
+    for (const auto z : zs) {
+        res = z > res ? z : res;
+    }
+    return res;
+}
+
+/**
+ * @brief Folds a chunk into a running sum, rescaling the sum when the chunk raises the maximum.
+ * @param acc Running maximum and sum.
+ * @param zs Chunk of logits.
+ */
+constexpr void accumulate(online_sum& acc, std::span<const double> zs) noexcept {
+    const auto max = std::max(acc.max, max_of(zs));
+    if (max == -std::numeric_limits<double>::infinity()) {
+        return;
+    }
+    auto sum = 0.0;
+    for (const auto z : zs) {
+        sum += constexpr_ops::exp(z - max);
+    }
+    acc.sum = acc.sum * constexpr_ops::exp(acc.max - max) + sum;
+    acc.max = max;
+}
+
+/**
+ * @brief Reduces a row chunk by chunk.
+ * @param zs Logits.
+ * @return Maximum and shifted sum of exponentials of the row.
+ */
+[[nodiscard]] constexpr auto reduce(std::span<const double> zs) noexcept {
+    online_sum acc;
+    for (std::size_t j = 0; j < zs.size(); j += SOFTMAX_CHUNK) {
+        accumulate(acc, zs.subspan(j, std::min(SOFTMAX_CHUNK, zs.size() - j)));
+    }
+    return acc;
+}
+
+/**
+ * @brief Combines the running sums of two parts of a row.
+ * @param lhs Maximum and sum of the first part.
+ * @param rhs Maximum and sum of the second part.
+ * @return Maximum and sum of both parts, rescaled to the larger maximum.
+ */
+[[nodiscard]] constexpr auto merge(const online_sum& lhs, const online_sum& rhs) noexcept {
+    const auto max = std::max(lhs.max, rhs.max);
+    if (max == -std::numeric_limits<double>::infinity()) {
+        return online_sum{};
+    }
+    return online_sum{max, lhs.sum * constexpr_ops::exp(lhs.max - max) +
+                               rhs.sum * constexpr_ops::exp(rhs.max - max)};
+}
+
+/**
+ * @brief Reduces a row block by block, merging the blocks along the pairwise tree of
+ * parallel::reduce without storing every partial.
+ *
+ * Each complete subtree stays on a stack until its sibling is done, so the stack holds one entry
+ * per set bit of the number of blocks so far; the leftovers are merged from the right at the end,
+ * exactly as the last, partial subtrees of parallel::reduce are.
+ *
+ * @param zs Logits.
+ * @param grain Number of elements per block, at least one.
+ * @return Maximum and shifted sum of exponentials of the row.
+ */
+[[nodiscard]] constexpr auto pairwise_reduce(std::span<const double> zs,
+                                             const std::size_t grain) noexcept {
+    std::array<online_sum, 64> stack{};
+    std::size_t top = 0;
+    for (std::size_t begin = 0, blocks = 1; begin < zs.size(); begin += grain, ++blocks) {
+        stack[top++] = reduce(zs.subspan(begin, std::min(grain, zs.size() - begin)));
+        for (auto n = blocks; n % 2 == 0; n /= 2) {
+            --top;
+            stack[top - 1] = merge(stack[top - 1], stack[top]);
+        }
+    }
+    if (top == 0) {
+        return online_sum{};
+    }
+    auto acc = stack[top - 1];
+    for (--top; top > 0; --top) {
+        acc = merge(stack[top - 1], acc);
+    }
+    return acc;
+}
+
+/**
+ * @brief Reduces a whole row, along the blocks and tree of parallel::reduce in reproducible
+ * builds, so that the single-threaded and the parallel softmax agree bitwise.
+ * @param zs Logits.
+ * @return Maximum and shifted sum of exponentials of the row.
+ */
+[[nodiscard]] constexpr auto reduce_row(std::span<const double> zs) noexcept {
+    if constexpr (parallel::REPRODUCIBLE) {
+        return pairwise_reduce(zs, parallel::GRAIN);
+    } else {
+        return reduce(zs);
+    }
+}
+
+/**
+ * @brief Computes the natural logarithm of a sum of shifted exponentials.
+ * @param acc Maximum and sum, the sum is at least one since the maximum contributes exp(0).
+ * @return log(sum(exp(z))) of the reduced row.
+ */
+[[nodiscard]] constexpr auto log_sum(const online_sum& acc) noexcept {
+    return acc.max + constexpr_ops::log1p(acc.sum - 1);
+}
+
+/**
+ * @brief Writes the normalized exponentials of a reduced row.
+ * @param zs Input values.
+ * @param out Output values, may alias the input.
+ * @param acc Maximum and sum of the row, an empty sum yields zeros instead of NaN.
+ */
+constexpr void normalize(std::span<const double> zs, std::span<double> out,
+                         const online_sum& acc) noexcept {
+    if (acc.sum == 0) {
+        std::fill(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(zs.size()), 0.0);
+        return;
+    }
+    const auto inv = 1 / acc.sum;
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        out[j] = constexpr_ops::exp(zs[j] - acc.max) * inv;
+    }
+}
+
+/**
+ * @brief Writes the log-probabilities of a reduced row.
+ * @param zs Input values.
+ * @param out Output values, may alias the input.
+ * @param acc Maximum and sum of the row, an empty sum yields negative infinity instead of NaN.
+ */
+constexpr void log_normalize(std::span<const double> zs, std::span<double> out,
+                             const online_sum& acc) noexcept {
+    if (acc.sum == 0) {
+        std::fill(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(zs.size()),
+                  -std::numeric_limits<double>::infinity());
+        return;
+    }
+    const auto lse = log_sum(acc);
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        out[j] = zs[j] - lse;
+    }
+}
+
+/**
+ * @brief Number of bits per word of a softmax mask.
+ */
+static const constexpr std::size_t MASK_BITS = 64;
+
+/**
+ * @brief Tests bit j of a mask, the least significant bit of the first word being position 0.
+ * @param mask Mask words.
+ * @param j Position.
+ * @return Whether position j is kept.
+ */
+[[nodiscard]] constexpr auto kept(std::span<const std::uint64_t> mask,
+                                  const std::size_t j) noexcept {
+    return ((mask[j / MASK_BITS] >> (j % MASK_BITS)) & 1) != 0;
+}
+
+/**
+ * @brief Softmax over rows too narrow to fill a vector, lanes running across rows.
+ *
+ * Blocks of SOFTMAX_LANES rows are transposed into a tile whose columns are rows, so the maximum,
+ * the exponentials and the sum are computed lane-wise without any horizontal reduction.
+ *
+ * @tparam Width Row width known at compile time, or zero to use the runtime width.
+ * @param in Input rows, at most SOFTMAX_SMALL_WIDTH wide.
+ * @param out Output rows, may alias the input, rows without any finite value yield zeros.
+ */
+template <std::size_t Width>
+constexpr void small_rows(matrix_view<const double> in, matrix_view<double> out) noexcept {
+    const auto width = Width == 0 ? in.cols : Width;
+    std::array<double, SOFTMAX_SMALL_WIDTH * SOFTMAX_LANES> tile{};
+    std::array<double, SOFTMAX_LANES> max{};
+    std::array<double, SOFTMAX_LANES> sum{};
+
+    for (std::size_t r0 = 0; r0 < in.rows; r0 += SOFTMAX_LANES) {
+        // A partial last block computes on stale lanes and only stores the valid ones.
+        const auto lanes = std::min(SOFTMAX_LANES, in.rows - r0);
+        for (std::size_t l = 0; l < lanes; ++l) {
+            const auto row = in.row(r0 + l);
+            for (std::size_t j = 0; j < width; ++j) {
+                tile[j * SOFTMAX_LANES + l] = row[j];
+            }
+        }
+
+        max.fill(-std::numeric_limits<double>::infinity());
+        sum.fill(0);
+        for (std::size_t j = 0; j < width; ++j) {
+            for (std::size_t l = 0; l < SOFTMAX_LANES; ++l) {
+                const auto z = tile[j * SOFTMAX_LANES + l];
+                max[l] = z > max[l] ? z : max[l];
+            }
+        }
+        // A fully masked row shifts by zero instead, so its exponentials and sum are all zero.
+        for (std::size_t l = 0; l < SOFTMAX_LANES; ++l) {
+            max[l] = max[l] == -std::numeric_limits<double>::infinity() ? 0 : max[l];
+        }
+        for (std::size_t j = 0; j < width; ++j) {
+            for (std::size_t l = 0; l < SOFTMAX_LANES; ++l) {
+                auto& z = tile[j * SOFTMAX_LANES + l];
+                z = constexpr_ops::exp(z - max[l]);
+                sum[l] += z;
+            }
+        }
+        for (std::size_t l = 0; l < SOFTMAX_LANES; ++l) {
+            sum[l] = sum[l] == 0 ? 0 : 1 / sum[l];
+        }
+
+        for (std::size_t l = 0; l < lanes; ++l) {
+            const auto row = out.row(r0 + l);
+            for (std::size_t j = 0; j < width; ++j) {
+                row[j] = tile[j * SOFTMAX_LANES + l] * sum[l];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Cross-entropy of one row, overwriting the logits with the gradient.
+ * @param logits Logits, replaced by scale * (softmax - target).
+ * @param label Index of the target class.
+ * @param smoothing Fraction of the target mass spread uniformly over all classes.
+ * @param scale Factor applied to the gradient.
+ * @return Cross-entropy loss of the row.
+ */
+constexpr auto cross_entropy_row(std::span<double> logits, const std::size_t label,
+                                 const double smoothing, const double scale) noexcept {
+    const auto n = logits.size();
+    online_sum acc;
+    auto total = 0.0;
+    for (std::size_t j = 0; j < n; j += SOFTMAX_CHUNK) {
+        const auto chunk = logits.subspan(j, std::min(SOFTMAX_CHUNK, n - j));
+        accumulate(acc, chunk);
+        // Masked vocabularies hold -inf logits, so the sum is only formed when it is weighted.
+        if (smoothing != 0) {
+            for (const auto z : chunk) {
+                total += z;
+            }
+        }
+    }
+
+    const auto uniform = smoothing / static_cast<double>(n);
+    auto loss = log_sum(acc) - (1 - smoothing) * logits[label];
+    if (smoothing != 0) {
+        loss -= uniform * total;
+    }
+
+    const auto inv = scale / acc.sum;
+    const auto offset = scale * uniform;
+    for (auto& z : logits) {
+        z = constexpr_ops::exp(z - acc.max) * inv - offset;
+    }
+    logits[label] -= scale * (1 - smoothing);
+    return loss;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Computes log(sum(exp(z))) without overflow.
+ * @param zs Input values.
+ * @return Log-sum-exp of the input values.
+ */
+[[nodiscard]] constexpr auto log_sum_exp(std::span<const double> zs) noexcept {
+    return detail::log_sum(detail::reduce_row(zs));
+}
+
+/**
+ * @brief Numerically stable softmax over one row.
+ * @param zs Input values.
+ * @param out Output values, may alias the input.
+ */
+constexpr void softmax(std::span<const double> zs, std::span<double> out) noexcept {
+    detail::normalize(zs, out, detail::reduce_row(zs));
+}
+
+/**
+ * @brief Numerically stable log-softmax over one row, z - log(sum(exp(z))).
+ * @param zs Input values.
+ * @param out Output values, may alias the input.
+ */
+constexpr void log_softmax(std::span<const double> zs, std::span<double> out) noexcept {
+    detail::log_normalize(zs, out, detail::reduce_row(zs));
+}
+
+/**
+ * @brief Softmax over every row of a matrix.
+ *
+ * Narrow rows, such as router logits or small classification heads, go through a kernel that
+ * normalizes several rows at once, one per SIMD lane, specialized at compile time for the
+ * common widths. Wider rows are normalized one at a time.
+ *
+ * @param in Input rows.
+ * @param out Output rows of the same shape, may alias the input.
+ */
+constexpr void softmax(matrix_view<const double> in, matrix_view<double> out) noexcept {
+    switch (in.cols) {
+        case 2:
+            detail::small_rows<2>(in, out);
+            break;
+        case 4:
+            detail::small_rows<4>(in, out);
+            break;
+        case 8:
+            detail::small_rows<8>(in, out);
+            break;
+        case 16:
+            detail::small_rows<16>(in, out);
+            break;
+        case 32:
+            detail::small_rows<32>(in, out);
+            break;
+        case 64:
+            detail::small_rows<64>(in, out);
+            break;
+        default:
+            if (in.cols <= SOFTMAX_SMALL_WIDTH) {
+                detail::small_rows<0>(in, out);
+                break;
+            }
+            for (std::size_t i = 0; i < in.rows; ++i) {
+                softmax(in.row(i), out.row(i));
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Softmax over the first positions of a row, such as a padded sequence or a causal
+ * attention row.
+ *
+ * The masked tail is neither read nor exponentiated, its probabilities are set to exactly zero,
+ * and a row without any valid position yields zeros.
+ *
+ * @param zs Input values.
+ * @param out Output values, may alias the input.
+ * @param valid Number of leading positions kept.
+ */
+constexpr void masked_softmax(std::span<const double> zs, std::span<double> out,
+                              std::size_t valid) noexcept {
+    valid = std::min(valid, zs.size());
+    const auto head = zs.first(valid);
+    detail::normalize(head, out, detail::reduce(head));
+    std::fill(out.begin() + static_cast<std::ptrdiff_t>(valid),
+              out.begin() + static_cast<std::ptrdiff_t>(zs.size()), 0.0);
+}
+
+/**
+ * @brief Softmax over the positions of a row selected by a bitmask.
+ *
+ * Words without any kept position are skipped without reading the row, masked positions get
+ * exactly zero probability, and a fully masked row yields zeros.
+ *
+ * @param zs Input values.
+ * @param out Output values, may alias the input.
+ * @param mask Bit j of word j / 64, counted from the least significant bit, keeps position j.
+ */
+constexpr void masked_softmax(std::span<const double> zs, std::span<double> out,
+                              std::span<const std::uint64_t> mask) noexcept {
+    const auto n = zs.size();
+    const auto inf = std::numeric_limits<double>::infinity();
+
+    auto max = -inf;
+    for (std::size_t j = 0; j < n; j += detail::MASK_BITS) {
+        if (mask[j / detail::MASK_BITS] == 0) {
+            continue;
+        }
+        for (auto k = j; k < std::min(n, j + detail::MASK_BITS); ++k) {
+            max = detail::kept(mask, k) && zs[k] > max ? zs[k] : max;
+        }
+    }
+
+    auto sum = 0.0;
+    if (max != -inf) {
+        for (std::size_t j = 0; j < n; j += detail::MASK_BITS) {
+            if (mask[j / detail::MASK_BITS] == 0) {
+                continue;
+            }
+            for (auto k = j; k < std::min(n, j + detail::MASK_BITS); ++k) {
+                sum += constexpr_ops::exp((detail::kept(mask, k) ? zs[k] : -inf) - max);
+            }
+        }
+    }
+
+    const auto inv = sum == 0 ? 0.0 : 1 / sum;
+    for (std::size_t j = 0; j < n; j += detail::MASK_BITS) {
+        const auto end = std::min(n, j + detail::MASK_BITS);
+        if (mask[j / detail::MASK_BITS] == 0 || sum == 0) {
+            std::fill(out.begin() + static_cast<std::ptrdiff_t>(j),
+                      out.begin() + static_cast<std::ptrdiff_t>(end), 0.0);
+            continue;
+        }
+        for (auto k = j; k < end; ++k) {
+            out[k] = detail::kept(mask, k) ? constexpr_ops::exp(zs[k] - max) * inv : 0.0;
+        }
+    }
+}
+
+/**
+ * @brief Causal softmax over the rows of an attention score matrix.
+ *
+ * Row i attends to the first i + offset + 1 keys, so only the lower trapezoid is read and
+ * exponentiated, about half of a square matrix, and the rest of each row is set to zero.
+ *
+ * @param scores Attention scores, one row per query.
+ * @param out Probabilities of the same shape, may alias the scores.
+ * @param offset Number of keys preceding the first query, such as cached tokens when decoding.
+ */
+constexpr void causal_softmax(matrix_view<const double> scores, matrix_view<double> out,
+                              const std::size_t offset = 0) noexcept {
+    for (std::size_t i = 0; i < scores.rows; ++i) {
+        masked_softmax(scores.row(i), out.row(i), i + offset + 1);
+    }
+}
+
+/**
+ * @brief Softmax over the valid prefix of every row, such as a batch of padded sequences.
+ * @param scores Input values, one row per sample.
+ * @param out Output values of the same shape, may alias the input.
+ * @param lengths Number of valid leading positions of each row.
+ */
+constexpr void masked_softmax(matrix_view<const double> scores, matrix_view<double> out,
+                              std::span<const std::size_t> lengths) noexcept {
+    for (std::size_t i = 0; i < scores.rows; ++i) {
+        masked_softmax(scores.row(i), out.row(i), lengths[i]);
+    }
+}
+
+/**
+ * @brief Softmax over the positions of every row selected by a row of bitmask words.
+ * @param scores Input values, one row per sample.
+ * @param out Output values of the same shape, may alias the input.
+ * @param mask Bitmask words, one row of ceil(cols / 64) words per sample.
+ */
+constexpr void masked_softmax(matrix_view<const double> scores, matrix_view<double> out,
+                              matrix_view<const std::uint64_t> mask) noexcept {
+    for (std::size_t i = 0; i < scores.rows; ++i) {
+        masked_softmax(scores.row(i), out.row(i), mask.row(i));
+    }
+}
+
+/**
+ * @brief Softmax over the stored entries of a sparse vector whose other entries share a default
+ * logit.
+ *
+ * The entries are given by their values alone; their indices, which must be distinct, carry
+ * over unchanged to the output. The dim - nnz absent entries enter the normalizer analytically
+ * as (dim - nnz) exp(fill), so the vector is never scattered into a dense one. A fill of
+ * negative infinity, the default, makes the absent entries vanish.
+ *
+ * @param values Stored logits.
+ * @param out Probabilities of the stored entries, may alias the values.
+ * @param dim Length of the dense vector, at least the number of stored entries.
+ * @param fill Logit of every absent entry.
+ * @return Probability of each absent entry, zero when there are none.
+ */
+constexpr auto sparse_softmax(
+    std::span<const double> values, std::span<double> out, const std::size_t dim = 0,
+    const double fill = -std::numeric_limits<double>::infinity()) noexcept {
+    const auto absent = dim > values.size() ? static_cast<double>(dim - values.size()) : 0.0;
+    auto acc = detail::reduce(values);
+    if (absent > 0) {
+        acc = detail::merge(acc, detail::online_sum{fill, absent});
+    }
+    detail::normalize(values, out, acc);
+    return absent == 0 || acc.sum == 0 ? 0.0 : constexpr_ops::exp(fill - acc.max) / acc.sum;
+}
+
+/**
+ * @brief Log-softmax over the stored entries of a sparse vector with a default logit.
+ * @param values Stored logits.
+ * @param out Log-probabilities of the stored entries, may alias the values.
+ * @param dim Length of the dense vector, at least the number of stored entries.
+ * @param fill Logit of every absent entry.
+ * @return Log-probability of each absent entry, negative infinity when there are none.
+ */
+constexpr auto sparse_log_softmax(
+    std::span<const double> values, std::span<double> out, const std::size_t dim = 0,
+    const double fill = -std::numeric_limits<double>::infinity()) noexcept {
+    const auto absent = dim > values.size() ? static_cast<double>(dim - values.size()) : 0.0;
+    auto acc = detail::reduce(values);
+    if (absent > 0) {
+        acc = detail::merge(acc, detail::online_sum{fill, absent});
+    }
+    detail::log_normalize(values, out, acc);
+    return absent == 0 || acc.sum == 0 ? -std::numeric_limits<double>::infinity()
+                                        : fill - detail::log_sum(acc);
+}
+
+/**
+ * @brief Fused softmax cross-entropy over one row of logits.
+ *
+ * The row is read once, chunk by chunk, to find its maximum and sum of exponentials, and once
+ * more to overwrite it with the gradient, so the probabilities are never stored separately.
+ *
+ * @param logits Logits, replaced by the gradient softmax - target.
+ * @param label Index of the target class, less than the number of logits.
+ * @param smoothing Label smoothing, the target is (1 - smoothing) * onehot + smoothing / V.
+ * @return Cross-entropy loss.
+ */
+constexpr auto softmax_cross_entropy(std::span<double> logits, const std::size_t label,
+                                     const double smoothing = 0) noexcept {
+    return detail::cross_entropy_row(logits, label, smoothing, 1);
+}
+
+/**
+ * @brief Fused softmax cross-entropy over a batch of logit rows, averaged over the rows whose
+ * label is not ignored.
+ * @param logits Logits, one row per sample, replaced by the gradient of the mean loss. Rows of
+ * ignored samples are zeroed.
+ * @param labels Target class of each row.
+ * @param smoothing Label smoothing, the target is (1 - smoothing) * onehot + smoothing / V.
+ * @param ignore_index Label marking rows that contribute neither loss nor gradient.
+ * @return Mean cross-entropy loss, zero when every row is ignored.
+ */
+constexpr auto softmax_cross_entropy(matrix_view<double> logits,
+                                     std::span<const std::int64_t> labels,
+                                     const double smoothing = 0,
+                                     const std::int64_t ignore_index = -100) noexcept {
+    const auto count = static_cast<std::size_t>(
+        std::count_if(labels.begin(), labels.end(),
+                      [&](const auto label) { return label != ignore_index; }));
+    const auto scale = count == 0 ? 0.0 : 1 / static_cast<double>(count);
+
+    auto loss = 0.0;
+    for (std::size_t i = 0; i < logits.rows; ++i) {
+        const auto row = logits.row(i);
+        if (labels[i] == ignore_index) {
+            std::fill(row.begin(), row.end(), 0.0);
+            continue;
+        }
+        loss += detail::cross_entropy_row(row, static_cast<std::size_t>(labels[i]), smoothing,
+                                          scale);
+    }
+    return loss * scale;
+}
+
+}  // namespace fun
+
+#endif  // SOFTMAX_HPP
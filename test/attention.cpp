@@ -0,0 +1,80 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../include/attention.hpp"
+#include "../include/fun.hpp"
+
+namespace {
+
+auto make_values(const std::size_t n, const std::size_t seed) {
+    std::vector<double> res(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        res[i] = static_cast<double>((i * 13 + seed * 7) % 29) / 7 - 2;
+    }
+    return res;
+}
+
+/**
+ * @brief Reference attention materializing the score matrix.
+ */
+auto naive(const std::vector<double>& q, const std::vector<double>& k, const std::vector<double>& v,
+           const std::size_t rows, const std::size_t keys, const std::size_t dim,
+           const double scale, const bool causal, const std::size_t offset) {
+    std::vector<double> res(rows * dim, 0.0);
+    for (std::size_t i = 0; i < rows; ++i) {
+        const auto valid = causal ? std::min(keys, i + offset + 1) : keys;
+        std::vector<double> scores(valid);
+        for (std::size_t j = 0; j < valid; ++j) {
+            for (std::size_t d = 0; d < dim; ++d) {
+                scores[j] += q[i * dim + d] * k[j * dim + d] * scale;
+            }
+        }
+        const auto probs = fun::softmax(scores);
+        for (std::size_t j = 0; j < valid; ++j) {
+            for (std::size_t d = 0; d < dim; ++d) {
+                res[i * dim + d] += probs[j] * v[j * dim + d];
+            }
+        }
+    }
+    return res;
+}
+
+}  // namespace
+
+TEST_CASE("Tiled attention", "[attention]") {
+    // Neither length is a multiple of the tile sizes.
+    const std::size_t rows = 2 * fun::ATTENTION_QUERY_TILE + 5;
+    const std::size_t keys = 3 * fun::ATTENTION_KEY_BLOCK + 11;
+    const std::size_t dim = 12;
+    const auto q = make_values(rows * dim, 1);
+    const auto k = make_values(keys * dim, 2);
+    const auto v = make_values(keys * dim, 3);
+    const auto scale = 1 / std::sqrt(static_cast<double>(dim));
+
+    const fun::matrix_view<const double> qv(q, rows, dim);
+    const fun::matrix_view<const double> kv(k, keys, dim);
+    const fun::matrix_view<const double> vv(v, keys, dim);
+    std::vector<double> out(rows * dim);
+    const fun::matrix_view<double> ov(out, rows, dim);
+
+    SECTION("Full") {
+        fun::attention(qv, kv, vv, ov, scale);
+        const auto ref = naive(q, k, v, rows, keys, dim, scale, false, 0);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            REQUIRE(out[i] == Catch::Approx(ref[i]).margin(1e-13));
+        }
+    }
+
+    SECTION("Causal with cached keys") {
+        const std::size_t offset = keys - rows;
+        fun::causal_attention(qv, kv, vv, ov, scale, offset);
+        const auto ref = naive(q, k, v, rows, keys, dim, scale, true, offset);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            REQUIRE(out[i] == Catch::Approx(ref[i]).margin(1e-13));
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+
+#include "../include/batch.hpp"
+
+namespace {
+
+/**
+ * @brief Inputs spanning both regimes, with a whole block in the linear regime.
+ */
+auto make_inputs() {
+    std::vector<double> zs;
+    for (auto z = -60.0; z <= 60.0; z += 0.125) {
+        zs.push_back(z);
+    }
+    zs.insert(zs.end(), fun::batch::BLOCK_SIZE * 2, 1e3);
+    return zs;
+}
+
+}  // namespace
+
+TEST_CASE("Batched linear-regime activations", "[batch][softplus][elu][mish]") {
+    const auto zs = make_inputs();
+    std::vector<double> out(zs.size());
+
+    fun::batch::softplus(zs, out);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(out[i] == fun::softplus(zs[i]));
+    }
+
+    fun::batch::elu(zs, out, 0.5);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(out[i] == fun::elu(zs[i], 0.5));
+    }
+
+    fun::batch::mish(zs, out);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(out[i] == fun::mish(zs[i]));
+    }
+
+    auto inplace = zs;
+    fun::batch::softplus(inplace, inplace);
+    fun::batch::softplus(zs, out);
+    REQUIRE(inplace == out);
+}
+
+TEST_CASE("Batched erf and GELU", "[batch][gelu]") {
+    const auto zs = make_inputs();
+    std::vector<double> out(zs.size());
+
+    fun::batch::erf(zs, out);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(out[i] == constexpr_ops::erf(zs[i]));
+    }
+
+    fun::batch::gelu<fun::gelu_mode::erf>(zs, out);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(out[i] == fun::gelu<fun::gelu_mode::erf>(zs[i]));
+    }
+
+    fun::batch::gelu<fun::gelu_mode::quick>(zs, out);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(out[i] == fun::gelu<fun::gelu_mode::quick>(zs[i]));
+    }
+}
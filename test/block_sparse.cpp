@@ -0,0 +1,47 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include "../include/block_sparse.hpp"
+#include "../include/fun.hpp"
+
+TEST_CASE("Block-sparse softmax", "[softmax]") {
+    const std::size_t width = 4;
+    const std::size_t area = width * width;
+    // Row block 2 stores no block at all.
+    const std::vector<std::size_t> row_offsets{0, 1, 3, 3, 5};
+    const std::vector<std::size_t> columns{0, 0, 1, 1, 3};
+    const fun::block_sparse_layout layout{width, row_offsets, columns};
+
+    std::vector<double> blocks(columns.size() * area);
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i] = static_cast<double>((i * 29) % 23) / 3 - 4;
+    }
+    std::vector<double> out(blocks.size());
+    fun::block_sparse_softmax(blocks, out, layout);
+
+    for (std::size_t i = 0; i + 1 < row_offsets.size(); ++i) {
+        for (std::size_t r = 0; r < width; ++r) {
+            std::vector<double> row;
+            for (auto b = row_offsets[i]; b < row_offsets[i + 1]; ++b) {
+                for (std::size_t j = 0; j < width; ++j) {
+                    row.push_back(blocks[b * area + r * width + j]);
+                }
+            }
+            if (row.empty()) {
+                continue;
+            }
+            const auto probs = fun::softmax(row);
+            std::size_t k = 0;
+            for (auto b = row_offsets[i]; b < row_offsets[i + 1]; ++b) {
+                for (std::size_t j = 0; j < width; ++j) {
+                    REQUIRE(out[b * area + r * width + j] == Catch::Approx(probs[k++]));
+                }
+            }
+        }
+    }
+
+    fun::block_sparse_softmax(blocks, blocks, layout);
+    REQUIRE(blocks == out);
+}
@@ -0,0 +1,142 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "../include/entmax.hpp"
+
+namespace {
+
+/**
+ * @brief Sort-based reference: sparsemax, or 1.5-entmax on z / 2.
+ */
+auto reference(const std::vector<double>& zs, const bool entmax) {
+    const auto scale = entmax ? 0.5 : 1.0;
+    std::vector<double> sorted;
+    for (const auto z : zs) {
+        sorted.push_back(scale * z);
+    }
+    std::sort(sorted.begin(), sorted.end(), std::greater<>());
+    auto sum = 0.0;
+    auto squares = 0.0;
+    auto tau = 0.0;
+    for (std::size_t k = 1; k <= sorted.size(); ++k) {
+        const auto x = sorted[k - 1];
+        const auto n = static_cast<double>(k);
+        sum += x;
+        squares += x * x;
+        const auto mean = sum / n;
+        const auto candidate =
+            entmax ? mean - std::sqrt(std::max(0.0, (1 - (squares - sum * mean)) / n))
+                   : (sum - 1) / n;
+        if (candidate < x) {
+            tau = candidate;
+        }
+    }
+    std::vector<double> res;
+    for (const auto z : zs) {
+        const auto p = std::max(0.0, scale * z - tau);
+        res.push_back(entmax ? p * p : p);
+    }
+    return res;
+}
+
+}  // namespace
+
+TEST_CASE("Sparsemax and 1.5-entmax", "[entmax]") {
+    for (const auto entmax : {false, true}) {
+        const auto forward = [&](const auto& zs, auto& out) {
+            entmax ? fun::entmax15(zs, out) : fun::sparsemax(zs, out);
+        };
+
+        SECTION(entmax ? "Entmax rows" : "Sparsemax rows") {
+            const std::size_t rows = 7;
+            const std::size_t cols = 203;
+            std::vector<double> zs(rows * cols);
+            for (std::size_t i = 0; i < zs.size(); ++i) {
+                // Spread grows with the row, so the support shrinks from dense to one entry.
+                const auto row = static_cast<double>(i / cols);
+                zs[i] = row * row * static_cast<double>((i * 37) % 101) / 50;
+            }
+            std::vector<double> out(zs.size());
+            const fun::matrix_view<const double> in(zs, rows, cols);
+            const fun::matrix_view<double> view(out, rows, cols);
+            entmax ? fun::entmax15(in, view) : fun::sparsemax(in, view);
+
+            std::vector<std::size_t> indices(cols);
+            std::vector<double> values(cols);
+            for (std::size_t i = 0; i < rows; ++i) {
+                const std::vector<double> row(in.row(i).begin(), in.row(i).end());
+                const auto ref = reference(row, entmax);
+                auto sum = 0.0;
+                for (std::size_t j = 0; j < cols; ++j) {
+                    sum += out[i * cols + j];
+                    REQUIRE(out[i * cols + j] == Catch::Approx(ref[j]).margin(1e-14));
+                }
+                REQUIRE(sum == Catch::Approx(1).epsilon(1e-14));
+
+                const auto count = entmax ? fun::entmax15(row, indices, values)
+                                          : fun::sparsemax(row, indices, values);
+                std::size_t k = 0;
+                for (std::size_t j = 0; j < cols; ++j) {
+                    if (ref[j] > 0) {
+                        REQUIRE(k < count);
+                        REQUIRE(indices[k] == j);
+                        REQUIRE(values[k++] == Catch::Approx(ref[j]).margin(1e-14));
+                    }
+                }
+                REQUIRE(k == count);
+            }
+        }
+
+        SECTION(entmax ? "Entmax edge cases" : "Sparsemax edge cases") {
+            std::vector<double> one{3.5};
+            forward(one, one);
+            REQUIRE(one[0] == Catch::Approx(1));
+
+            // Ties and a huge offset.
+            std::vector<double> ties{1e6, 1e6, 1e6 - 10, 1e6};
+            forward(ties, ties);
+            for (const auto j : {0, 1, 3}) {
+                REQUIRE(ties[static_cast<std::size_t>(j)] == Catch::Approx(1.0 / 3));
+            }
+            REQUIRE(ties[2] == 0);
+        }
+
+        SECTION(entmax ? "Entmax backward" : "Sparsemax backward") {
+            const std::size_t n = 40;
+            std::vector<double> zs(n);
+            std::vector<double> grad(n);
+            for (std::size_t j = 0; j < n; ++j) {
+                zs[j] = static_cast<double>((j * 13) % 17) / 9;
+                grad[j] = static_cast<double>(j % 5) - 2;
+            }
+            std::vector<double> probs(n);
+            forward(zs, probs);
+            std::vector<double> grad_in(n);
+            entmax ? fun::entmax15_backward(probs, grad, grad_in)
+                   : fun::sparsemax_backward(probs, grad, grad_in);
+
+            const auto loss = [&](const std::vector<double>& xs) {
+                const auto ps = reference(xs, entmax);
+                auto res = 0.0;
+                for (std::size_t j = 0; j < n; ++j) {
+                    res += grad[j] * ps[j];
+                }
+                return res;
+            };
+            const auto h = 1e-6;
+            for (std::size_t j = 0; j < n; ++j) {
+                auto plus = zs;
+                auto minus = zs;
+                plus[j] += h;
+                minus[j] -= h;
+                const auto numeric = (loss(plus) - loss(minus)) / (2 * h);
+                REQUIRE(grad_in[j] == Catch::Approx(numeric).margin(1e-8));
+            }
+        }
+    }
+}
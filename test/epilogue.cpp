@@ -0,0 +1,46 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include "../include/epilogue.hpp"
+
+TEST_CASE("Fused bias and activation", "[epilogue]") {
+    const std::size_t rows = 5;
+    const std::size_t cols = 19;
+    const std::size_t stride = 24;
+    std::vector<double> xs(rows * stride, -100);
+    std::vector<double> bias(cols);
+    for (std::size_t j = 0; j < cols; ++j) {
+        bias[j] = static_cast<double>(j) / 4 - 2;
+        for (std::size_t i = 0; i < rows; ++i) {
+            xs[i * stride + j] = static_cast<double>(i) - 2;
+        }
+    }
+
+    const fun::matrix_view<const double> in(xs.data(), rows, cols, stride);
+
+    SECTION("Out of place") {
+        std::vector<double> out(rows * cols);
+        fun::bias_activate(in, bias, fun::matrix_view<double>(out, rows, cols),
+                           fun::activation::gelu_erf);
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t j = 0; j < cols; ++j) {
+                const auto ref = fun::gelu<fun::gelu_mode::erf>(xs[i * stride + j] + bias[j]);
+                REQUIRE(out[i * cols + j] == ref);
+            }
+        }
+    }
+
+    SECTION("In place with padding") {
+        auto inout = xs;
+        fun::bias_activate(fun::matrix_view<double>(inout.data(), rows, cols, stride), bias,
+                           fun::activation::leaky_relu);
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t j = 0; j < stride; ++j) {
+                const auto val = xs[i * stride + j];
+                REQUIRE(inout[i * stride + j] == (j < cols ? fun::leaky_relu(val + bias[j]) : val));
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "../include/expr.hpp"
+#include "../include/fun.hpp"
+
+TEST_CASE("Fused expression evaluation", "[expr]") {
+    const std::size_t rows = 7;
+    const std::size_t cols = 13;
+    std::vector<double> xs(rows * cols);
+    std::vector<double> residual(rows * cols);
+    std::vector<double> bias(cols);
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        xs[i] = static_cast<double>(i % 17) / 4 - 2;
+        residual[i] = static_cast<double>(i % 5) - 2;
+    }
+    for (std::size_t j = 0; j < cols; ++j) {
+        bias[j] = static_cast<double>(j) / 8 - 0.5;
+    }
+
+    namespace ex = fun::expr;
+    std::vector<double> out(xs.size());
+
+    SECTION("GELU epilogue") {
+        const auto e =
+            ex::apply<fun::gelu<fun::gelu_mode::erf>>(ex::input(xs) + ex::bias(bias)) * 0.5 +
+            ex::input(residual);
+        ex::evaluate(e, out, cols);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            const auto ref = fun::gelu<fun::gelu_mode::erf>(xs[i] + bias[i % cols]) * 0.5;
+            REQUIRE(out[i] == Catch::Approx(ref + residual[i]));
+        }
+    }
+
+    SECTION("Parametric activation and clamp") {
+        const auto e = ex::clamp(ex::apply<fun::elu>(2.0 * ex::input(xs) - 1, 0.5), -0.25, 1.0);
+        ex::evaluate(e, out);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            const auto ref = std::clamp(fun::elu(2 * xs[i] - 1, 0.5), -0.25, 1.0);
+            REQUIRE(out[i] == Catch::Approx(ref));
+        }
+    }
+
+    SECTION("In place") {
+        auto inplace = xs;
+        ex::evaluate(ex::apply<fun::relu>(ex::input(inplace) * ex::bias(bias)), inplace, cols);
+        for (std::size_t i = 0; i < xs.size(); ++i) {
+            REQUIRE(inplace[i] == fun::relu(xs[i] * bias[i % cols]));
+        }
+    }
+
+    SECTION("Partial last row and no columns") {
+        // Two full rows and three values of a third, which must not be written past.
+        std::vector<double> partial(2 * cols + 3 + 1, 42);
+        const auto view = std::span<double>(partial).first(2 * cols + 3);
+        ex::evaluate(ex::input(xs) + ex::bias(bias), view, cols);
+        for (std::size_t i = 0; i < view.size(); ++i) {
+            REQUIRE(partial[i] == xs[i] + bias[i % cols]);
+        }
+        REQUIRE(partial.back() == 42);
+
+        ex::evaluate(ex::input(xs) + 1, view, 0);
+        REQUIRE(partial[0] == xs[0] + bias[0]);
+    }
+}
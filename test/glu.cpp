@@ -0,0 +1,84 @@
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "../include/glu.hpp"
+
+namespace {
+
+/**
+ * @brief Reference GLU over separate spans, built from the scalar activations and derivatives.
+ */
+template <fun::glu_variant V>
+auto reference(const double gate, const double up) {
+    if constexpr (V == fun::glu_variant::swiglu) {
+        return std::array<double, 3>{fun::silu(gate) * up, fun::derivative::silu(gate) * up,
+                                     fun::silu(gate)};
+    } else if constexpr (V == fun::glu_variant::geglu) {
+        const auto act = fun::gelu<fun::gelu_mode::erf>(gate);
+        return std::array<double, 3>{act * up,
+                                     fun::derivative::gelu<fun::gelu_mode::erf>(gate) * up, act};
+    } else if constexpr (V == fun::glu_variant::geglu_tanh) {
+        const auto act = fun::gelu<fun::gelu_mode::tanh>(gate);
+        return std::array<double, 3>{act * up,
+                                     fun::derivative::gelu<fun::gelu_mode::tanh>(gate) * up, act};
+    } else {
+        return std::array<double, 3>{fun::relu(gate) * up, fun::derivative::relu(gate) * up,
+                                     fun::relu(gate)};
+    }
+}
+
+template <fun::glu_variant V>
+void check(const fun::glu_layout layout) {
+    const std::size_t rows = 3;
+    const std::size_t hidden = 17;
+    std::vector<double> in(rows * 2 * hidden);
+    std::vector<double> grad(rows * hidden);
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<double>(i % 13) / 3 - 2;
+    }
+    for (std::size_t i = 0; i < grad.size(); ++i) {
+        grad[i] = static_cast<double>(i % 5) - 2;
+    }
+
+    std::vector<double> out(rows * hidden);
+    std::vector<double> grad_in(in.size());
+    const fun::matrix_view<const double> in_view(in.data(), rows, 2 * hidden, 2 * hidden);
+    fun::glu<V>(in_view, fun::matrix_view<double>(out, rows, hidden), layout);
+    fun::glu_backward<V>(in_view, fun::matrix_view<const double>(grad.data(), rows, hidden, hidden),
+                         fun::matrix_view<double>(grad_in, rows, 2 * hidden), layout);
+
+    for (std::size_t i = 0; i < rows; ++i) {
+        for (std::size_t j = 0; j < hidden; ++j) {
+            const auto g = layout == fun::glu_layout::concatenated ? j : 2 * j;
+            const auto u = layout == fun::glu_layout::concatenated ? hidden + j : 2 * j + 1;
+            const auto row = i * 2 * hidden;
+            const auto ref = reference<V>(in[row + g], in[row + u]);
+            const auto dy = grad[i * hidden + j];
+            REQUIRE(out[i * hidden + j] == Catch::Approx(ref[0]).margin(1e-15));
+            REQUIRE(grad_in[row + g] == Catch::Approx(dy * ref[1]).margin(1e-12));
+            REQUIRE(grad_in[row + u] == Catch::Approx(dy * ref[2]).margin(1e-15));
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Gated linear units", "[glu]") {
+    for (const auto layout : {fun::glu_layout::concatenated, fun::glu_layout::interleaved}) {
+        check<fun::glu_variant::swiglu>(layout);
+        check<fun::glu_variant::geglu>(layout);
+        check<fun::glu_variant::geglu_tanh>(layout);
+        check<fun::glu_variant::reglu>(layout);
+    }
+
+    const std::vector<double> gate = {-1.5, 0.25, 3};
+    const std::vector<double> up = {2, -4, 0.5};
+    std::vector<double> out(gate.size());
+    fun::glu<fun::glu_variant::swiglu>(gate, up, out);
+    for (std::size_t i = 0; i < gate.size(); ++i) {
+        REQUIRE(out[i] == Catch::Approx(fun::silu(gate[i]) * up[i]));
+    }
+}
@@ -0,0 +1,94 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../include/gumbel.hpp"
+
+TEST_CASE("Gumbel-softmax", "[gumbel]") {
+    const std::size_t rows = 4;
+    const std::size_t cols = 6;
+    std::vector<double> logits(rows * cols);
+    for (std::size_t k = 0; k < logits.size(); ++k) {
+        logits[k] = static_cast<double>((k * 5) % 7) / 3 - 1;
+    }
+    const fun::matrix_view<const double> zs(logits, rows, cols);
+    std::vector<double> out(logits.size());
+    const fun::matrix_view<double> view(out, rows, cols);
+    const double temperature = 0.7;
+    const std::uint64_t seed = 1234;
+
+    // Relaxed sample with the noise of the same counters computed separately.
+    const auto relaxed = [&](const std::vector<double>& xs, const std::uint64_t step) {
+        std::vector<double> res(xs.size());
+        for (std::size_t i = 0; i < rows; ++i) {
+            auto sum = 0.0;
+            for (std::size_t j = 0; j < cols; ++j) {
+                const auto k = i * cols + j;
+                const auto g = -std::log(-std::log(fun::uniform(seed, k, step)));
+                res[k] = std::exp((xs[k] + g) / temperature);
+                sum += res[k];
+            }
+            for (std::size_t j = 0; j < cols; ++j) {
+                res[i * cols + j] /= sum;
+            }
+        }
+        return res;
+    };
+
+    SECTION("Soft") {
+        fun::gumbel_softmax(zs, view, temperature, seed, 3);
+        const auto ref = relaxed(logits, 3);
+        for (std::size_t k = 0; k < out.size(); ++k) {
+            REQUIRE(out[k] == Catch::Approx(ref[k]).epsilon(1e-12));
+        }
+    }
+
+    SECTION("Hard samples follow the softmax") {
+        const std::size_t steps = 20000;
+        std::vector<double> counts(logits.size());
+        for (std::uint64_t step = 0; step < steps; ++step) {
+            fun::gumbel_softmax(zs, view, temperature, seed, step, true);
+            for (std::size_t k = 0; k < out.size(); ++k) {
+                REQUIRE((out[k] == 0 || out[k] == 1));
+                counts[k] += out[k];
+            }
+        }
+        std::vector<double> probs(logits.size());
+        fun::softmax(zs, fun::matrix_view<double>(probs, rows, cols));
+        for (std::size_t k = 0; k < out.size(); ++k) {
+            const auto sd = std::sqrt(probs[k] * (1 - probs[k]) / steps);
+            REQUIRE(std::abs(counts[k] / steps - probs[k]) <= 5 * sd);
+        }
+    }
+
+    SECTION("Backward") {
+        std::vector<double> grad(logits.size());
+        for (std::size_t k = 0; k < grad.size(); ++k) {
+            grad[k] = static_cast<double>(k % 4) - 1.5;
+        }
+        std::vector<double> grad_logits(logits.size());
+        fun::gumbel_softmax_backward(zs, fun::matrix_view<const double>(grad, rows, cols),
+                                     fun::matrix_view<double>(grad_logits, rows, cols),
+                                     temperature, seed, 9);
+        const auto loss = [&](const std::vector<double>& xs) {
+            const auto ys = relaxed(xs, 9);
+            auto res = 0.0;
+            for (std::size_t k = 0; k < ys.size(); ++k) {
+                res += grad[k] * ys[k];
+            }
+            return res;
+        };
+        const auto h = 1e-6;
+        for (std::size_t k = 0; k < logits.size(); ++k) {
+            auto plus = logits;
+            auto minus = logits;
+            plus[k] += h;
+            minus[k] -= h;
+            REQUIRE(grad_logits[k] == Catch::Approx((loss(plus) - loss(minus)) / (2 * h))
+                                          .margin(1e-8));
+        }
+    }
+}
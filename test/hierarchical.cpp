@@ -0,0 +1,116 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "../include/hierarchical.hpp"
+
+TEST_CASE("Hierarchical softmax", "[hierarchical]") {
+    const std::size_t num_classes = 40;
+    const std::size_t width = 5;
+    std::vector<double> frequencies(num_classes);
+    for (std::size_t c = 0; c < num_classes; ++c) {
+        frequencies[c] = 1000 / static_cast<double>((c * 7) % num_classes + 1);
+    }
+    const auto tree = fun::build_class_tree(frequencies);
+
+    SECTION("Tree") {
+        std::vector<int> seen(num_classes);
+        for (std::size_t k = 0; k < tree.clusters(); ++k) {
+            const auto classes = tree.classes(k);
+            REQUIRE(!classes.empty());
+            REQUIRE(classes.size() <= 2 * 7);
+            for (std::size_t s = 0; s < classes.size(); ++s) {
+                REQUIRE(tree.cluster[classes[s]] == k);
+                REQUIRE(tree.slot[classes[s]] == s);
+                seen[classes[s]] += 1;
+            }
+        }
+        for (const auto count : seen) {
+            REQUIRE(count == 1);
+        }
+        // The most frequent class gets a cluster of its own.
+        REQUIRE(tree.classes(0).size() == 1);
+        REQUIRE(tree.classes(0)[0] == 0);
+    }
+
+    SECTION("Zero frequencies") {
+        const std::vector<double> zeros(10000, 0.0);
+        const auto flat = fun::build_class_tree(zeros);
+        REQUIRE(flat.clusters() == 100);
+        for (std::size_t k = 0; k < flat.clusters(); ++k) {
+            REQUIRE(flat.classes(k).size() == 100);
+        }
+    }
+
+    const auto fill = [](std::vector<double>& xs, const std::size_t seed) {
+        for (std::size_t i = 0; i < xs.size(); ++i) {
+            xs[i] = static_cast<double>((i * 37 + seed * 11) % 29) / 14 - 1;
+        }
+    };
+    std::vector<double> wc(tree.clusters() * width);
+    std::vector<double> wo(num_classes * width);
+    const std::size_t batch = 3;
+    std::vector<double> hs(batch * width);
+    fill(wc, 1);
+    fill(wo, 2);
+    fill(hs, 3);
+    const std::vector<std::size_t> targets{0, 17, 39};
+    const auto views = [&](const std::vector<double>& c, const std::vector<double>& o) {
+        return std::pair{fun::matrix_view<const double>(c, tree.clusters(), width),
+                         fun::matrix_view<const double>(o, num_classes, width)};
+    };
+
+    SECTION("Normalized") {
+        const auto [cv, ov] = views(wc, wo);
+        const auto h = std::span<const double>(hs).first(width);
+        auto total = 0.0;
+        for (std::size_t c = 0; c < num_classes; ++c) {
+            total += std::exp(fun::hierarchical_log_probability(h, tree, cv, ov, c));
+        }
+        REQUIRE(total == Catch::Approx(1).epsilon(1e-12));
+    }
+
+    SECTION("Gradients") {
+        const auto loss = [&](const std::vector<double>& c, const std::vector<double>& o,
+                              const std::vector<double>& x) {
+            const auto [cv, ov] = views(c, o);
+            auto res = 0.0;
+            for (std::size_t i = 0; i < batch; ++i) {
+                const auto h = std::span<const double>(x).subspan(i * width, width);
+                res -= fun::hierarchical_log_probability(h, tree, cv, ov, targets[i]);
+            }
+            return res / batch;
+        };
+
+        std::vector<double> gh(hs.size(), -1);
+        std::vector<double> gc(wc.size());
+        std::vector<double> go(wo.size());
+        const auto [cv, ov] = views(wc, wo);
+        const auto value = fun::hierarchical_softmax_loss(
+            fun::matrix_view<const double>(hs, batch, width), targets, tree, cv, ov,
+            fun::matrix_view<double>(gh, batch, width),
+            fun::matrix_view<double>(gc, tree.clusters(), width),
+            fun::matrix_view<double>(go, num_classes, width));
+        REQUIRE(value == Catch::Approx(loss(wc, wo, hs)));
+
+        const auto h = 1e-6;
+        const auto check = [&](std::vector<double>& xs, const std::vector<double>& grad) {
+            for (std::size_t i = 0; i < xs.size(); ++i) {
+                const auto saved = xs[i];
+                xs[i] = saved + h;
+                const auto plus = loss(wc, wo, hs);
+                xs[i] = saved - h;
+                const auto minus = loss(wc, wo, hs);
+                xs[i] = saved;
+                REQUIRE(grad[i] == Catch::Approx((plus - minus) / (2 * h)).margin(1e-8));
+            }
+        };
+        check(hs, gh);
+        check(wc, gc);
+        check(wo, go);
+    }
+}
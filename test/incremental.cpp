@@ -0,0 +1,102 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../include/incremental.hpp"
+
+namespace {
+
+/**
+ * @brief Recomputes the log-normalizer of the held logits from scratch.
+ */
+auto reference(const fun::incremental_softmax& soft, const std::vector<bool>& held) {
+    auto max = -std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < held.size(); ++i) {
+        max = held[i] ? std::max(max, soft.logit(i)) : max;
+    }
+    auto sum = 0.0;
+    for (std::size_t i = 0; i < held.size(); ++i) {
+        sum += held[i] ? std::exp(soft.logit(i) - max) : 0;
+    }
+    return max + std::log(sum);
+}
+
+}  // namespace
+
+TEST_CASE("Incremental softmax", "[incremental]") {
+    std::vector<double> zs(37);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        zs[i] = static_cast<double>((i * 29) % 23) / 4 - 3;
+    }
+    fun::incremental_softmax soft(zs);
+    std::vector<bool> held(zs.size(), true);
+
+    const auto check = [&] {
+        const auto lse = reference(soft, held);
+        REQUIRE(soft.log_normalizer() == Catch::Approx(lse).epsilon(1e-13));
+        auto total = 0.0;
+        for (std::size_t i = 0; i < held.size(); ++i) {
+            if (held[i]) {
+                total += soft.probability(i);
+                REQUIRE(soft.log_probability(i) == Catch::Approx(soft.logit(i) - lse));
+            }
+        }
+        REQUIRE(total == Catch::Approx(1).epsilon(1e-13));
+    };
+    check();
+
+    SECTION("Updates, insertions and removals") {
+        for (std::size_t step = 0; step < 500; ++step) {
+            const auto i = (step * 7919) % held.size();
+            const auto z = static_cast<double>((step * 31) % 41) / 5 - 4;
+            if (step % 5 == 0) {
+                const auto j = soft.insert(z);
+                // Vacant slots are reused before the index range grows.
+                held.resize(std::max(held.size(), j + 1), false);
+                REQUIRE(!held[j]);
+                held[j] = true;
+            } else if (step % 5 == 1 && held[i] && soft.size() > 1) {
+                soft.remove(i);
+                held[i] = false;
+            } else if (held[i]) {
+                soft.update(i, z);
+            }
+            check();
+        }
+    }
+
+    SECTION("Rebasing") {
+        // Far above the shift, then the only large logit collapses back down.
+        soft.update(3, 5000);
+        REQUIRE(soft.probability(3) == Catch::Approx(1));
+        check();
+        soft.update(3, -5000);
+        check();
+        REQUIRE(soft.probability(3) == 0);
+        REQUIRE(soft.log_probability(3) == Catch::Approx(-5000 - reference(soft, held)));
+    }
+
+    SECTION("Sampling") {
+        soft.remove(0);
+        held[0] = false;
+        soft.remove(10);
+        held[10] = false;
+        std::vector<double> counts(held.size());
+        const std::size_t draws = 200000;
+        for (std::uint64_t c = 0; c < draws; ++c) {
+            counts[soft.sample(42, c)] += 1;
+        }
+        for (std::size_t i = 0; i < held.size(); ++i) {
+            const auto p = held[i] ? soft.probability(i) : 0;
+            const auto sd = std::sqrt(p * (1 - p) / draws);
+            REQUIRE(std::abs(counts[i] / draws - p) <= 5 * sd);
+        }
+        // The top of the last interval never lands on a vacant or padding leaf.
+        REQUIRE(soft.sample(std::nextafter(1.0, 0.0)) == held.size() - 1);
+    }
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../include/loss.hpp"
+
+TEST_CASE("Binary cross-entropy with logits", "[loss]") {
+    // Several blocks, so partial sums come from more than one thread.
+    const std::size_t n = 3 * fun::parallel::GRAIN + 5;
+    std::vector<double> logits(n);
+    std::vector<double> targets(n);
+    std::vector<double> weights(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        logits[i] = static_cast<double>(i % 41) / 4 - 5;
+        targets[i] = static_cast<double>(i % 3) / 2;
+        weights[i] = static_cast<double>(i % 5) + 0.5;
+    }
+
+    auto ref = 0.0;
+    auto weighted = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto p = 1 / (1 + std::exp(-logits[i]));
+        const auto loss = -(targets[i] * std::log(p) + (1 - targets[i]) * std::log(1 - p));
+        ref += loss;
+        weighted += weights[i] * loss;
+    }
+    ref /= static_cast<double>(n);
+    weighted /= static_cast<double>(n);
+
+    REQUIRE(fun::bce_with_logits(logits, targets) == Catch::Approx(ref).epsilon(1e-12));
+
+    std::vector<double> grad(n);
+    const auto loss = fun::bce_with_logits(logits, targets, weights, grad);
+    REQUIRE(loss == Catch::Approx(weighted).epsilon(1e-12));
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto p = 1 / (1 + std::exp(-logits[i]));
+        const auto expected = weights[i] * (p - targets[i]) / static_cast<double>(n);
+        REQUIRE(grad[i] == Catch::Approx(expected).margin(1e-18));
+    }
+
+    SECTION("Confident predictions") {
+        const std::vector<double> zs{800, -800, 40};
+        const std::vector<double> ys{0, 1, 1};
+        REQUIRE(fun::bce_with_logits(zs, ys) == Catch::Approx((800 + 800 + std::exp(-40)) / 3));
+    }
+}
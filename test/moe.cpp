@@ -0,0 +1,130 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../include/moe.hpp"
+
+TEST_CASE("Top-k gating", "[moe]") {
+    const std::size_t tokens = 5;
+    const std::size_t num_experts = 11;
+    const std::size_t k = 3;
+    std::vector<double> logits(tokens * num_experts);
+    for (std::size_t i = 0; i < logits.size(); ++i) {
+        logits[i] = static_cast<double>((i * 17) % 31) / 6 - 2;
+    }
+    std::vector<double> grad_weights(tokens * k);
+    for (std::size_t i = 0; i < grad_weights.size(); ++i) {
+        grad_weights[i] = static_cast<double>(i % 4) - 1.5;
+    }
+
+    const fun::matrix_view<const double> zs(logits, tokens, num_experts);
+    std::vector<std::size_t> experts(tokens * k);
+    std::vector<double> weights(tokens * k);
+    const fun::matrix_view<std::size_t> ev(experts, tokens, k);
+    const fun::matrix_view<double> wv(weights, tokens, k);
+
+    for (const auto mode : {fun::gating_softmax::selected, fun::gating_softmax::full}) {
+        fun::topk_gating(zs, ev, wv, mode);
+
+        for (std::size_t i = 0; i < tokens; ++i) {
+            const auto row = zs.row(i);
+            auto full = 0.0;
+            for (const auto z : row) {
+                full += std::exp(z);
+            }
+            auto selected = 0.0;
+            for (std::size_t s = 0; s < k; ++s) {
+                selected += std::exp(row[experts[i * k + s]]);
+            }
+            for (std::size_t s = 0; s < k; ++s) {
+                const auto e = experts[i * k + s];
+                // Every unselected logit is smaller, ties resolved towards the lower index.
+                for (std::size_t j = 0; j < num_experts; ++j) {
+                    bool chosen = false;
+                    for (std::size_t t = 0; t < k; ++t) {
+                        chosen = chosen || experts[i * k + t] == j;
+                    }
+                    REQUIRE((chosen || row[j] < row[e] || (row[j] == row[e] && j > e)));
+                }
+                const auto norm = mode == fun::gating_softmax::full ? full : selected;
+                REQUIRE(weights[i * k + s] == Catch::Approx(std::exp(row[e]) / norm));
+            }
+        }
+
+        // Finite differences of sum(grad_weights * weights), the selection held fixed.
+        std::vector<double> grad_logits(logits.size());
+        const fun::matrix_view<const double> gw(grad_weights, tokens, k);
+        const fun::matrix_view<double> gz(grad_logits, tokens, num_experts);
+        fun::topk_gating_backward(zs, ev, wv, gw, gz, mode);
+        const auto loss = [&](const std::vector<double>& xs) {
+            auto res = 0.0;
+            for (std::size_t i = 0; i < tokens; ++i) {
+                auto norm = 0.0;
+                for (std::size_t j = 0; j < num_experts; ++j) {
+                    bool chosen = mode == fun::gating_softmax::full;
+                    for (std::size_t t = 0; t < k; ++t) {
+                        chosen = chosen || experts[i * k + t] == j;
+                    }
+                    norm += chosen ? std::exp(xs[i * num_experts + j]) : 0;
+                }
+                for (std::size_t s = 0; s < k; ++s) {
+                    const auto w = std::exp(xs[i * num_experts + experts[i * k + s]]) / norm;
+                    res += grad_weights[i * k + s] * w;
+                }
+            }
+            return res;
+        };
+        const auto h = 1e-6;
+        for (std::size_t i = 0; i < logits.size(); ++i) {
+            auto plus = logits;
+            auto minus = logits;
+            plus[i] += h;
+            minus[i] -= h;
+            const auto numeric = (loss(plus) - loss(minus)) / (2 * h);
+            REQUIRE(grad_logits[i] == Catch::Approx(numeric).margin(1e-8));
+        }
+    }
+}
+
+TEST_CASE("Top-k gating edge cases", "[moe]") {
+    const std::size_t tokens = 2;
+    const std::size_t num_experts = 3;
+    const std::vector<double> logits{0.5, -1, 2, 1, 1, 0};
+    const fun::matrix_view<const double> zs(logits, tokens, num_experts);
+
+    // No expert selected: nothing is read or written.
+    fun::topk_gating(zs, fun::matrix_view<std::size_t>(), fun::matrix_view<double>());
+
+    // More slots than experts: every expert is selected, the extra slots are empty.
+    const std::size_t k = 5;
+    std::vector<std::size_t> experts(tokens * k, 42);
+    std::vector<double> weights(tokens * k, -1);
+    const fun::matrix_view<std::size_t> ev(experts, tokens, k);
+    const fun::matrix_view<double> wv(weights, tokens, k);
+    fun::topk_gating(zs, ev, wv);
+
+    std::vector<double> full(logits.size());
+    fun::softmax(zs, fun::matrix_view<double>(full, tokens, num_experts));
+    for (std::size_t i = 0; i < tokens; ++i) {
+        for (std::size_t s = 0; s < k; ++s) {
+            const auto e = experts[i * k + s];
+            if (s < num_experts) {
+                REQUIRE(weights[i * k + s] == Catch::Approx(full[i * num_experts + e]));
+            } else {
+                REQUIRE(e == num_experts);
+                REQUIRE(weights[i * k + s] == 0);
+            }
+        }
+    }
+
+    const std::vector<double> grad_weights(tokens * k, 1);
+    std::vector<double> grad_logits(logits.size(), -1);
+    fun::topk_gating_backward(zs, ev, wv, fun::matrix_view<const double>(grad_weights, tokens, k),
+                              fun::matrix_view<double>(grad_logits, tokens, num_experts));
+    // The weights always sum to one, so a uniform output gradient passes nothing back.
+    for (const auto g : grad_logits) {
+        REQUIRE(g == Catch::Approx(0).margin(1e-15));
+    }
+}
@@ -0,0 +1,84 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "../include/parallel_softmax.hpp"
+
+TEST_CASE("Intra-row parallel softmax", "[parallel_softmax]") {
+    const std::size_t n = 300001;
+    std::vector<double> zs(n);
+    for (std::size_t j = 0; j < n; ++j) {
+        zs[j] = static_cast<double>((j * 7919) % 1009) / 50 + (j == 123456 ? 900 : 0);
+    }
+    std::vector<double> ref(n);
+    fun::softmax(zs, ref);
+    const auto lse = fun::log_sum_exp(zs);
+
+    for (const auto mode : {fun::reduction::fast, fun::reduction::deterministic}) {
+        for (const std::size_t grain : {1000, 65536}) {
+            REQUIRE(fun::parallel_log_sum_exp(zs, mode, grain) == Catch::Approx(lse));
+            std::vector<double> out(n);
+            fun::parallel_softmax(zs, out, mode, grain);
+            for (std::size_t j = 0; j < n; ++j) {
+                REQUIRE(out[j] == Catch::Approx(ref[j]).margin(1e-15));
+            }
+            fun::parallel_log_softmax(zs, out, mode, grain);
+            for (std::size_t j = 0; j < n; j += 97) {
+                REQUIRE(out[j] == Catch::Approx(zs[j] - lse));
+            }
+        }
+    }
+
+    // The deterministic mode matches a serial pairwise merge of the same blocks bit for bit.
+    const std::size_t grain = 4096;
+    std::vector<fun::detail::online_sum> partials;
+    for (std::size_t j = 0; j < n; j += grain) {
+        const auto block = std::span<const double>(zs).subspan(j, std::min(grain, n - j));
+        partials.push_back(fun::detail::reduce(block));
+    }
+    while (partials.size() > 1) {
+        std::vector<fun::detail::online_sum> next;
+        for (std::size_t i = 0; i < partials.size(); i += 2) {
+            next.push_back(i + 1 < partials.size()
+                               ? fun::detail::merge(partials[i], partials[i + 1])
+                               : partials[i]);
+        }
+        partials = next;
+    }
+    REQUIRE(fun::parallel_log_sum_exp(zs, fun::reduction::deterministic, grain) ==
+            fun::detail::log_sum(partials.front()));
+
+    // So does the single-threaded one, for any number of blocks.
+    const auto tree = fun::detail::pairwise_reduce(zs, grain);
+    REQUIRE(tree.max == partials.front().max);
+    REQUIRE(tree.sum == partials.front().sum);
+    for (std::size_t blocks = 0; blocks <= 9; ++blocks) {
+        const auto row = std::span<const double>(zs).first(blocks * 1000 - (blocks > 0 ? 7 : 0));
+        const auto serial = fun::detail::pairwise_reduce(row, 1000);
+        const auto parallel = fun::detail::parallel_reduce(row, 1000);
+        REQUIRE(serial.max == parallel.max);
+        REQUIRE(serial.sum == parallel.sum);
+    }
+
+    // Reproducible builds route the single-row softmax through that tree.
+    if constexpr (fun::parallel::REPRODUCIBLE) {
+        std::vector<double> out(n);
+        fun::parallel_softmax(zs, out);
+        REQUIRE(out == ref);
+        REQUIRE(fun::parallel_log_sum_exp(zs) == lse);
+    }
+
+    // A zero grain is taken as one element per block.
+    const auto head = std::span<const double>(zs).first(1000);
+    for (const auto mode : {fun::reduction::fast, fun::reduction::deterministic}) {
+        REQUIRE(fun::parallel_log_sum_exp(head, mode, 0) ==
+                Catch::Approx(fun::log_sum_exp(head)));
+    }
+
+    std::vector<double> empty;
+    REQUIRE(std::isinf(fun::parallel_log_sum_exp(empty)));
+}
@@ -0,0 +1,76 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "../include/pipeline.hpp"
+
+TEST_CASE("Runtime pipeline", "[pipeline]") {
+    const std::size_t cols = 300;
+    const std::size_t size = cols * 11;
+    std::vector<double> xs(size);
+    std::vector<double> gate(size);
+    std::vector<double> bias(cols);
+    for (std::size_t i = 0; i < size; ++i) {
+        xs[i] = static_cast<double>(i % 23) / 4 - 3;
+        gate[i] = static_cast<double>(i % 7) / 3 - 1;
+    }
+    for (std::size_t j = 0; j < cols; ++j) {
+        bias[j] = static_cast<double>(j % 9) / 10;
+    }
+
+    fun::pipeline pipe;
+    pipe.add_bias(bias)
+        .activate(fun::activation::silu)
+        .multiply(gate)
+        .scale(2)
+        .clamp(-1, 1.5)
+        .activate(fun::activation::elu, 0.5);
+
+    std::vector<double> out(size);
+    pipe.run(xs, out, cols);
+    for (std::size_t i = 0; i < size; ++i) {
+        const auto val = std::clamp(fun::silu(xs[i] + bias[i % cols]) * gate[i] * 2, -1.0, 1.5);
+        REQUIRE(out[i] == Catch::Approx(fun::elu(val, 0.5)));
+    }
+
+    auto inplace = xs;
+    pipe.run(inplace, inplace, cols);
+    REQUIRE(inplace == out);
+
+    SECTION("Partial last row and no columns") {
+        // 2.5 rows, so the block split has to stop mid-row.
+        const std::vector<double> ys(cols * 5 / 2, 1.0);
+        std::vector<double> biased(ys.size());
+        fun::pipeline().add_bias(bias).run(ys, biased, cols);
+        for (std::size_t i = 0; i < ys.size(); ++i) {
+            REQUIRE(biased[i] == 1 + bias[i % cols]);
+        }
+
+        std::vector<double> untouched(ys.size(), -1.0);
+        fun::pipeline().add_bias(bias).run(ys, untouched, 0);
+        REQUIRE(std::all_of(untouched.begin(), untouched.end(), [](double v) { return v == -1; }));
+    }
+}
+
+TEST_CASE("Runtime activation selector", "[batch]") {
+    std::vector<double> zs;
+    for (auto z = -5.0; z <= 5.0; z += 0.25) {
+        zs.push_back(z);
+    }
+    std::vector<double> out(zs.size());
+
+    fun::batch::activate(fun::activation::parametric_relu, zs, out, 0.3);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(out[i] == fun::parametric_relu(zs[i], 0.3));
+    }
+    fun::batch::activate(fun::activation::gelu_erf, zs, out);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(out[i] == fun::gelu<fun::gelu_mode::erf>(zs[i]));
+    }
+    fun::batch::activate(fun::activation::gcs, zs, out);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(out[i] == fun::gcs(zs[i]));
+    }
+}
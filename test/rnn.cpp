@@ -0,0 +1,148 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../include/rnn.hpp"
+
+namespace {
+
+auto sigmoid(const double x) {
+    return 1 / (1 + std::exp(-x));
+}
+
+auto make_values(const std::size_t n, const std::size_t seed) {
+    std::vector<double> res(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        res[i] = static_cast<double>((i * 7 + seed) % 11) / 4 - 1.25;
+    }
+    return res;
+}
+
+/**
+ * @brief Weighted sum used as a scalar loss for finite differences.
+ */
+auto dot(const std::vector<double>& lhs, const std::vector<double>& rhs) {
+    auto res = 0.0;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        res += lhs[i] * rhs[i];
+    }
+    return res;
+}
+
+}  // namespace
+
+TEST_CASE("LSTM cell", "[rnn]") {
+    const std::size_t hidden = 9;
+    const auto gates = make_values(4 * hidden, 1);
+    const auto c_prev = make_values(hidden, 2);
+    const auto grad_h = make_values(hidden, 3);
+    const auto grad_c = make_values(hidden, 4);
+
+    std::vector<double> c(hidden);
+    std::vector<double> h(hidden);
+    fun::lstm_cell(gates, c_prev, c, h);
+    for (std::size_t j = 0; j < hidden; ++j) {
+        const auto cell = sigmoid(gates[hidden + j]) * c_prev[j] +
+                          sigmoid(gates[j]) * std::tanh(gates[2 * hidden + j]);
+        REQUIRE(c[j] == Catch::Approx(cell).margin(1e-15));
+        const auto ref = sigmoid(gates[3 * hidden + j]) * std::tanh(cell);
+        REQUIRE(h[j] == Catch::Approx(ref).margin(1e-15));
+    }
+
+    std::vector<double> grad_gates(4 * hidden);
+    std::vector<double> grad_c_prev(hidden);
+    fun::lstm_cell_backward(gates, c_prev, grad_h, grad_c, grad_gates, grad_c_prev);
+
+    const auto loss = [&](const std::vector<double>& g, const std::vector<double>& cp) {
+        fun::lstm_cell(g, cp, c, h);
+        return dot(grad_h, h) + dot(grad_c, c);
+    };
+    const auto eps = 1e-6;
+    for (std::size_t k = 0; k < gates.size(); ++k) {
+        auto lo = gates;
+        auto hi = gates;
+        lo[k] -= eps;
+        hi[k] += eps;
+        const auto diff = (loss(hi, c_prev) - loss(lo, c_prev)) / (2 * eps);
+        REQUIRE(grad_gates[k] == Catch::Approx(diff).margin(1e-8));
+    }
+    for (std::size_t k = 0; k < hidden; ++k) {
+        auto lo = c_prev;
+        auto hi = c_prev;
+        lo[k] -= eps;
+        hi[k] += eps;
+        const auto diff = (loss(gates, hi) - loss(gates, lo)) / (2 * eps);
+        REQUIRE(grad_c_prev[k] == Catch::Approx(diff).margin(1e-8));
+    }
+}
+
+TEST_CASE("GRU cell", "[rnn]") {
+    const std::size_t batch = 2;
+    const std::size_t hidden = 7;
+    const auto gates_x = make_values(batch * 3 * hidden, 1);
+    const auto gates_h = make_values(batch * 3 * hidden, 5);
+    const auto h_prev = make_values(batch * hidden, 2);
+    const auto grad_h = make_values(batch * hidden, 3);
+
+    const auto view = [](const std::vector<double>& v, const std::size_t cols) {
+        return fun::matrix_view<const double>(v.data(), batch, cols, cols);
+    };
+    std::vector<double> h(batch * hidden);
+    const auto forward = [&](const std::vector<double>& gx, const std::vector<double>& gh,
+                             const std::vector<double>& hp) {
+        fun::gru_cell(view(gx, 3 * hidden), view(gh, 3 * hidden), view(hp, hidden),
+                      fun::matrix_view<double>(h, batch, hidden));
+        return dot(grad_h, h);
+    };
+
+    forward(gates_x, gates_h, h_prev);
+    for (std::size_t i = 0; i < batch; ++i) {
+        for (std::size_t j = 0; j < hidden; ++j) {
+            const auto* gx = &gates_x[i * 3 * hidden];
+            const auto* gh = &gates_h[i * 3 * hidden];
+            const auto r = sigmoid(gx[j] + gh[j]);
+            const auto z = sigmoid(gx[hidden + j] + gh[hidden + j]);
+            const auto cand = std::tanh(gx[2 * hidden + j] + r * gh[2 * hidden + j]);
+            const auto ref = (1 - z) * cand + z * h_prev[i * hidden + j];
+            REQUIRE(h[i * hidden + j] == Catch::Approx(ref).margin(1e-15));
+        }
+    }
+
+    std::vector<double> grad_gates_x(gates_x.size());
+    std::vector<double> grad_gates_h(gates_h.size());
+    std::vector<double> grad_h_prev(h_prev.size());
+    fun::gru_cell_backward(view(gates_x, 3 * hidden), view(gates_h, 3 * hidden),
+                           view(h_prev, hidden), view(grad_h, hidden),
+                           fun::matrix_view<double>(grad_gates_x, batch, 3 * hidden),
+                           fun::matrix_view<double>(grad_gates_h, batch, 3 * hidden),
+                           fun::matrix_view<double>(grad_h_prev, batch, hidden));
+
+    const auto eps = 1e-6;
+    for (std::size_t k = 0; k < gates_x.size(); ++k) {
+        auto lo = gates_x;
+        auto hi = gates_x;
+        lo[k] -= eps;
+        hi[k] += eps;
+        const auto diff = (forward(hi, gates_h, h_prev) - forward(lo, gates_h, h_prev)) / (2 * eps);
+        REQUIRE(grad_gates_x[k] == Catch::Approx(diff).margin(1e-8));
+
+        lo = gates_h;
+        hi = gates_h;
+        lo[k] -= eps;
+        hi[k] += eps;
+        const auto diff_h =
+            (forward(gates_x, hi, h_prev) - forward(gates_x, lo, h_prev)) / (2 * eps);
+        REQUIRE(grad_gates_h[k] == Catch::Approx(diff_h).margin(1e-8));
+    }
+    for (std::size_t k = 0; k < h_prev.size(); ++k) {
+        auto lo = h_prev;
+        auto hi = h_prev;
+        lo[k] -= eps;
+        hi[k] += eps;
+        const auto diff =
+            (forward(gates_x, gates_h, hi) - forward(gates_x, gates_h, lo)) / (2 * eps);
+        REQUIRE(grad_h_prev[k] == Catch::Approx(diff).margin(1e-8));
+    }
+}
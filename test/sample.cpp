@@ -0,0 +1,85 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../include/random.hpp"
+#include "../include/sample.hpp"
+
+TEST_CASE("Counter-based generator", "[random]") {
+    // Known-answer vectors of the Random123 reference implementation.
+    const auto zero = fun::philox({0, 0, 0, 0}, {0, 0});
+    REQUIRE(zero == std::array<std::uint32_t, 4>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    const auto ones = fun::philox({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                                  {0xffffffff, 0xffffffff});
+    REQUIRE(ones == std::array<std::uint32_t, 4>{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+
+    auto mean = 0.0;
+    const std::size_t n = 100000;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto u = fun::uniform(42, i);
+        REQUIRE(u >= 0);
+        REQUIRE(u < 1);
+        mean += u / n;
+    }
+    REQUIRE(mean == Catch::Approx(0.5).margin(0.005));
+    REQUIRE(fun::uniform(42, 7) == fun::uniform(42, 7));
+    REQUIRE(fun::uniform(42, 7) != fun::uniform(43, 7));
+    REQUIRE(fun::uniform(42, 7) != fun::uniform(42, 7, 1));
+}
+
+TEST_CASE("Token sampling", "[sample]") {
+    const std::vector<double> logits{1.0, 3.0, -2.0, 2.5, 0.0, 3.0, -50.0, 1.5};
+    const std::size_t draws = 100000;
+
+    // Empirical frequencies against the renormalized probabilities of the expected support.
+    const auto check = [&](const fun::sampling& config, const std::vector<std::size_t>& support) {
+        std::vector<double> counts(logits.size());
+        for (std::size_t step = 0; step < draws; ++step) {
+            counts[fun::sample(logits, config, step)] += 1;
+        }
+        auto total = 0.0;
+        for (const auto t : support) {
+            total += std::exp(logits[t] / config.temperature);
+        }
+        for (std::size_t t = 0; t < logits.size(); ++t) {
+            auto expected = 0.0;
+            for (const auto s : support) {
+                expected = s == t ? std::exp(logits[t] / config.temperature) / total : expected;
+            }
+            REQUIRE(counts[t] / draws == Catch::Approx(expected).margin(0.01));
+        }
+    };
+
+    SECTION("Greedy") {
+        REQUIRE(fun::sample(logits, {.temperature = 0}, 3) == 1);
+        REQUIRE(fun::sample(logits, {.top_k = 1}, 3) == 1);
+    }
+
+    SECTION("Temperature only") {
+        check({.temperature = 1.5, .seed = 1}, {0, 1, 2, 3, 4, 5, 6, 7});
+    }
+
+    SECTION("Top-k") {
+        check({.temperature = 0.8, .top_k = 3, .seed = 2}, {1, 3, 5});
+    }
+
+    SECTION("Top-p") {
+        // Tokens 1 and 5 hold about 0.66 of the mass, adding token 3 about 0.86.
+        check({.top_p = 0.8, .seed = 3}, {1, 3, 5});
+        check({.top_p = 0.6, .seed = 4}, {1, 5});
+    }
+
+    SECTION("Top-k then top-p") {
+        check({.top_k = 4, .top_p = 0.8, .seed = 5}, {1, 3, 5});
+    }
+
+    SECTION("Reproducible") {
+        const fun::sampling config{.temperature = 1.2, .top_p = 0.9, .seed = 9};
+        for (std::uint64_t step = 0; step < 100; ++step) {
+            REQUIRE(fun::sample(logits, config, step) == fun::sample(logits, config, step));
+        }
+    }
+}
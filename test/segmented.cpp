@@ -0,0 +1,54 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../include/fun.hpp"
+#include "../include/segmented.hpp"
+
+TEST_CASE("Segmented softmax", "[softmax]") {
+    // Empty, tiny and block-sized segments next to two that span several blocks.
+    const std::size_t grain = 64;
+    const std::vector<std::size_t> lengths{3, 0, 1, 64, 65, 500, 7, 0, 200, 2};
+    std::vector<std::size_t> ids;
+    for (std::size_t s = 0; s < lengths.size(); ++s) {
+        ids.insert(ids.end(), lengths[s], s);
+    }
+    const auto offsets = fun::segment_offsets(ids, lengths.size());
+    REQUIRE(offsets.size() == lengths.size() + 1);
+    REQUIRE(offsets.back() == ids.size());
+
+    std::vector<double> zs(ids.size());
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        zs[i] = static_cast<double>((i * 31) % 47) / 5 - 4;
+    }
+
+    std::vector<double> probs(zs.size());
+    std::vector<double> logs(zs.size());
+    fun::segmented_softmax(zs, offsets, probs, grain);
+    fun::segmented_log_softmax(zs, offsets, logs, grain);
+
+    for (std::size_t s = 0; s < lengths.size(); ++s) {
+        if (lengths[s] == 0) {
+            continue;
+        }
+        const std::vector<double> seg(zs.begin() + static_cast<long>(offsets[s]),
+                                      zs.begin() + static_cast<long>(offsets[s + 1]));
+        const auto ref = fun::softmax(seg);
+        for (std::size_t j = 0; j < seg.size(); ++j) {
+            REQUIRE(probs[offsets[s] + j] == Catch::Approx(ref[j]).epsilon(1e-12));
+            REQUIRE(logs[offsets[s] + j] == Catch::Approx(std::log(ref[j])).epsilon(1e-12));
+        }
+    }
+
+    // A zero grain is taken as one element per block.
+    std::vector<double> fine(zs.size());
+    fun::segmented_softmax(zs, offsets, fine, 0);
+    for (std::size_t i = 0; i < zs.size(); ++i) {
+        REQUIRE(fine[i] == Catch::Approx(probs[i]).epsilon(1e-12));
+    }
+
+    fun::segmented_softmax(zs, offsets, zs, grain);
+    REQUIRE(zs == probs);
+}
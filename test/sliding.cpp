@@ -0,0 +1,40 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../include/sliding.hpp"
+
+TEST_CASE("Sliding-window log-sum-exp", "[sliding]") {
+    std::vector<double> zs(1000);
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        // Slow drift and bursts far above it, so the window maximum keeps moving.
+        zs[j] = static_cast<double>(j) / 2 + (j % 97 == 0 ? 800 : static_cast<double>(j % 13));
+    }
+
+    for (const std::size_t window : {1, 7, 64, 2000}) {
+        std::vector<double> out(zs.size());
+        fun::sliding_log_sum_exp(zs, window, out);
+
+        fun::sliding_softmax state(window);
+        for (std::size_t j = 0; j < zs.size(); ++j) {
+            const auto first = j + 1 > window ? j + 1 - window : 0;
+            auto max = zs[first];
+            for (auto k = first; k <= j; ++k) {
+                max = std::max(max, zs[k]);
+            }
+            auto sum = 0.0;
+            for (auto k = first; k <= j; ++k) {
+                sum += std::exp(zs[k] - max);
+            }
+            const auto ref = max + std::log(sum);
+            REQUIRE(out[j] == Catch::Approx(ref).epsilon(1e-14));
+
+            state.push(zs[j]);
+            REQUIRE(state.size() == j + 1 - first);
+            REQUIRE(state.newest_probability() == Catch::Approx(std::exp(zs[j] - ref)));
+        }
+    }
+}
@@ -0,0 +1,228 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../include/fun.hpp"
+#include "../include/softmax.hpp"
+
+namespace {
+
+auto make_logits(const std::size_t n, const std::size_t seed) {
+    std::vector<double> res(n);
+    for (std::size_t j = 0; j < n; ++j) {
+        res[j] = static_cast<double>((j * 37 + seed * 11) % 101) / 8 - 6;
+    }
+    return res;
+}
+
+/**
+ * @brief Unfused reference: materializes the probabilities, then the loss and gradient.
+ */
+auto reference(const std::vector<double>& zs, const std::size_t label, const double smoothing,
+               std::vector<double>& grad) {
+    auto max = zs[0];
+    for (const auto z : zs) {
+        max = std::max(max, z);
+    }
+    auto sum = 0.0;
+    for (const auto z : zs) {
+        sum += std::exp(z - max);
+    }
+    const auto n = static_cast<double>(zs.size());
+    auto loss = 0.0;
+    grad.resize(zs.size());
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        const auto target = (j == label ? 1 - smoothing : 0) + smoothing / n;
+        loss -= target * (zs[j] - max - std::log(sum));
+        grad[j] = std::exp(zs[j] - max) / sum - target;
+    }
+    return loss;
+}
+
+}  // namespace
+
+TEST_CASE("Softmax", "[softmax]") {
+    const auto zs = make_logits(5000, 1);
+    std::vector<double> out(zs.size());
+    fun::softmax(zs, out);
+    const auto probs = fun::softmax(zs);
+    auto sum = 0.0;
+    for (std::size_t j = 0; j < zs.size(); ++j) {
+        sum += out[j];
+        REQUIRE(out[j] == Catch::Approx(probs[j]).epsilon(1e-12));
+    }
+    REQUIRE(sum == Catch::Approx(1).epsilon(1e-12));
+
+    const std::vector<double> large{1000, 1001, 1002};
+    const auto shifted = fun::softmax(large);
+    REQUIRE(shifted[2] == Catch::Approx(1 / (1 + std::exp(-1) + std::exp(-2))));
+    const auto lse = 1002 + std::log1p(std::exp(-1) + std::exp(-2));
+    REQUIRE(fun::log_sum_exp(large) == Catch::Approx(lse));
+
+    REQUIRE(fun::softmax(std::vector<double>{}).empty());
+}
+
+TEST_CASE("Row-wise softmax", "[softmax]") {
+    // Specialized, runtime small and wide widths, with a partial last block of rows.
+    for (const std::size_t cols : {2, 5, 16, 64, 65}) {
+        const std::size_t rows = 3 * fun::SOFTMAX_LANES + 3;
+        auto zs = make_logits(rows * cols, cols);
+        // A fully masked row yields zeros, as the single-row softmax does.
+        std::fill(zs.begin() + static_cast<long>(cols), zs.begin() + static_cast<long>(2 * cols),
+                  -std::numeric_limits<double>::infinity());
+        std::vector<double> out(rows * cols);
+        fun::softmax(fun::matrix_view<const double>(zs, rows, cols),
+                     fun::matrix_view<double>(out, rows, cols));
+        for (std::size_t i = 0; i < rows; ++i) {
+            const std::vector<double> row(zs.begin() + static_cast<long>(i * cols),
+                                          zs.begin() + static_cast<long>((i + 1) * cols));
+            std::vector<double> ref(cols);
+            fun::softmax(std::span<const double>(row), std::span<double>(ref));
+            for (std::size_t j = 0; j < cols; ++j) {
+                REQUIRE(out[i * cols + j] == Catch::Approx(ref[j]).epsilon(1e-12));
+                REQUIRE((i != 1 || out[i * cols + j] == 0));
+            }
+        }
+    }
+}
+
+TEST_CASE("Fused softmax cross-entropy", "[softmax]") {
+    // Wider than one chunk so the running maximum is rescaled across chunks.
+    const std::size_t vocab = 2 * fun::SOFTMAX_CHUNK + 77;
+
+    for (const auto smoothing : {0.0, 0.1}) {
+        SECTION("Single row, smoothing " + std::to_string(smoothing)) {
+            auto logits = make_logits(vocab, 2);
+            logits[vocab - 1] = 9;
+            std::vector<double> grad;
+            const auto ref = reference(logits, 123, smoothing, grad);
+            const auto loss = fun::softmax_cross_entropy(logits, 123, smoothing);
+            REQUIRE(loss == Catch::Approx(ref).epsilon(1e-12));
+            for (std::size_t j = 0; j < vocab; ++j) {
+                REQUIRE(logits[j] == Catch::Approx(grad[j]).margin(1e-15));
+            }
+        }
+    }
+
+    SECTION("Batch with ignored rows") {
+        const std::size_t rows = 4;
+        const std::size_t stride = vocab + 3;
+        std::vector<double> logits(rows * stride, 42);
+        for (std::size_t i = 0; i < rows; ++i) {
+            const auto row = make_logits(vocab, i);
+            std::copy(row.begin(), row.end(), logits.begin() + static_cast<long>(i * stride));
+        }
+        const std::vector<std::int64_t> labels{5, -100, 4000, 17};
+        const auto input = logits;
+
+        const auto loss = fun::softmax_cross_entropy(
+            fun::matrix_view<double>(logits.data(), rows, vocab, stride), labels, 0.05);
+
+        auto ref = 0.0;
+        for (std::size_t i = 0; i < rows; ++i) {
+            const auto first = input.begin() + static_cast<long>(i * stride);
+            const std::vector<double> row(first, first + static_cast<long>(vocab));
+            std::vector<double> grad(vocab, 0.0);
+            if (labels[i] != -100) {
+                ref += reference(row, static_cast<std::size_t>(labels[i]), 0.05, grad) / 3;
+            }
+            for (std::size_t j = 0; j < stride; ++j) {
+                const auto val = logits[i * stride + j];
+                REQUIRE(val == Catch::Approx(j < vocab ? grad[j] / 3 : 42).margin(1e-15));
+            }
+        }
+        REQUIRE(loss == Catch::Approx(ref).epsilon(1e-12));
+    }
+}
+
+TEST_CASE("Masked softmax", "[softmax]") {
+    const std::size_t rows = 6;
+    const std::size_t cols = 150;
+    const auto scores = make_logits(rows * cols, 3);
+    const fun::matrix_view<const double> in(scores, rows, cols);
+
+    // Dense softmax over the kept positions only, zeros elsewhere.
+    const auto check = [&](const std::vector<double>& out, auto keep) {
+        for (std::size_t i = 0; i < rows; ++i) {
+            std::vector<double> kept;
+            for (std::size_t j = 0; j < cols; ++j) {
+                if (keep(i, j)) {
+                    kept.push_back(scores[i * cols + j]);
+                }
+            }
+            const auto probs = kept.empty() ? kept : fun::softmax(kept);
+            std::size_t k = 0;
+            for (std::size_t j = 0; j < cols; ++j) {
+                const auto ref = keep(i, j) ? probs[k++] : 0.0;
+                REQUIRE(out[i * cols + j] == Catch::Approx(ref).margin(1e-15));
+            }
+        }
+    };
+
+    std::vector<double> out(rows * cols, -1);
+    const fun::matrix_view<double> view(out, rows, cols);
+
+    SECTION("Causal") {
+        fun::causal_softmax(in, view, 2);
+        check(out, [](const auto i, const auto j) { return j <= i + 2; });
+    }
+
+    SECTION("Valid lengths") {
+        const std::vector<std::size_t> lengths{0, 1, 64, 65, 150, 500};
+        fun::masked_softmax(in, view, lengths);
+        check(out, [&](const auto i, const auto j) { return j < lengths[i]; });
+    }
+
+    SECTION("Bitmask") {
+        const std::size_t words = 3;
+        std::vector<std::uint64_t> mask(rows * words);
+        for (std::size_t i = 1; i < rows; ++i) {
+            mask[i * words] = 0xf0f0f0f0f0f0f0f0ULL >> i;
+            mask[i * words + 2] = i % 2 == 0 ? 0x3fffffULL : 0;
+        }
+        const auto bit = [&](const auto i, const auto j) {
+            return ((mask[i * words + j / 64] >> (j % 64)) & 1) != 0;
+        };
+        fun::masked_softmax(in, view, fun::matrix_view<const std::uint64_t>(mask, rows, words));
+        check(out, bit);
+    }
+}
+
+TEST_CASE("Sparse softmax", "[softmax]") {
+    const std::size_t dim = 100'000;
+    const std::vector<std::size_t> indices{3, 17, 500, 4242, 99'999};
+    const std::vector<double> values{2.5, -1, 0.25, 7, 3};
+
+    for (const auto fill : {-std::numeric_limits<double>::infinity(), -2.0, 4.0}) {
+        std::vector<double> dense(dim, fill);
+        for (std::size_t k = 0; k < indices.size(); ++k) {
+            dense[indices[k]] = values[k];
+        }
+        const auto lse = fun::log_sum_exp(dense);
+
+        std::vector<double> out(values.size());
+        const auto rest = fun::sparse_softmax(values, out, dim, fill);
+        REQUIRE(rest == Catch::Approx(std::exp(fill - lse)).margin(1e-300));
+        for (std::size_t k = 0; k < values.size(); ++k) {
+            REQUIRE(out[k] == Catch::Approx(std::exp(values[k] - lse)));
+        }
+
+        const auto log_rest = fun::sparse_log_softmax(values, out, dim, fill);
+        REQUIRE(log_rest == Catch::Approx(fill - lse));
+        for (std::size_t k = 0; k < values.size(); ++k) {
+            REQUIRE(out[k] == Catch::Approx(values[k] - lse));
+        }
+    }
+
+    // Without absent entries the default logit plays no part.
+    std::vector<double> out(values.size());
+    REQUIRE(fun::sparse_softmax(values, out, values.size(), 1e6) == 0);
+    REQUIRE(out[3] == Catch::Approx(std::exp(7 - fun::log_sum_exp(values))));
+}
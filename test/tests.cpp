@@ -1,5 +1,9 @@
 #include <catch2/catch_all.hpp>
 
+#include <cmath>
+#include <limits>
+#include <numbers>
+
 #include "../include/fun.hpp"
 
 #define RANGE_START 1
@@ -35,3 +39,119 @@ TEST_CASE("Parametric ReLU", "[parametricrelu]") {
         }
     }
 }
+
+TEST_CASE("expm1 and log1p", "[constexpr_ops]") {
+    static_assert(constexpr_ops::expm1(0.0) == 0);
+    static_assert(constexpr_ops::log1p(0.0) == 0);
+
+    for (const auto val : {1e-300, 1e-12, 1e-5, 0.1, 0.5, 1.0, 5.0, 30.0, 300.0}) {
+        for (const auto sgn : {-1.0, 1.0}) {
+            const auto x = sgn * val;
+            REQUIRE(constexpr_ops::expm1(x) == Catch::Approx(std::expm1(x)).epsilon(1e-14));
+            REQUIRE(constexpr_ops::exp(x) == Catch::Approx(std::exp(x)).epsilon(1e-14));
+            if (x > -1) {
+                REQUIRE(constexpr_ops::log1p(x) == Catch::Approx(std::log1p(x)).epsilon(1e-14));
+            }
+        }
+    }
+    REQUIRE(std::isinf(constexpr_ops::exp(1e3)));
+    REQUIRE(constexpr_ops::exp(-1e3) == 0);
+    REQUIRE(constexpr_ops::expm1(-1e3) == -1);
+    REQUIRE(std::isinf(constexpr_ops::log1p(-1.0)));
+
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+    REQUIRE(std::isnan(constexpr_ops::expm1(nan)));
+    REQUIRE(std::isnan(constexpr_ops::log1p(nan)));
+    REQUIRE(std::isnan(fun::tanh(nan)));
+    REQUIRE(std::isnan(fun::elu(nan, 1.0)));
+}
+
+TEST_CASE("log", "[constexpr_ops]") {
+    static_assert(constexpr_ops::log(1.0) == 0);
+
+    for (const auto x : {4e-320, 1e-300, 1e-12, 0.1, 0.7, 1 - 1e-12, 1.5, 1e5, 1e300}) {
+        REQUIRE(constexpr_ops::log(x) == Catch::Approx(std::log(x)).epsilon(1e-15));
+    }
+    REQUIRE(std::isinf(constexpr_ops::log(0.0)));
+    REQUIRE(std::isnan(constexpr_ops::log(-1.0)));
+}
+
+TEST_CASE("Softplus, ELU and Mish", "[softplus][elu][mish]") {
+    for (f32 val = RANGE_START; val <= RANGE_END; val += STEP_SIZE) {
+        for (const auto z : {static_cast<double>(val), static_cast<double>(-val)}) {
+            REQUIRE(fun::softplus(z) == Catch::Approx(std::log1p(std::exp(z))).epsilon(1e-13));
+            REQUIRE(fun::elu(z, 0.5) ==
+                    Catch::Approx(z < 0 ? 0.5 * std::expm1(z) : z).epsilon(1e-13));
+            REQUIRE(fun::mish(z) ==
+                    Catch::Approx(z * std::tanh(std::log1p(std::exp(z)))).epsilon(1e-13));
+        }
+    }
+
+    REQUIRE(fun::softplus(1e3) == 1e3);
+    REQUIRE(fun::softplus(-1e3) == 0);
+    REQUIRE(fun::softplus(-50.0) == Catch::Approx(std::exp(-50.0)).epsilon(1e-13));
+    REQUIRE(fun::elu(-1e-10, 1) == Catch::Approx(std::expm1(-1e-10)).epsilon(1e-13));
+    REQUIRE(fun::mish(1e3) == 1e3);
+    REQUIRE(fun::tanh(1e3) == 1);
+}
+
+static const constexpr auto CUBIC = std::array<double, 4>{1, -2, 0.5, 3};
+
+TEST_CASE("Polynomial evaluation", "[constexpr_ops]") {
+    static_assert(constexpr_ops::horner<CUBIC>(2.0) == 1 - 4 + 2 + 24);
+    static_assert(constexpr_ops::estrin<CUBIC>(2.0) == 1 - 4 + 2 + 24);
+    static_assert(constexpr_ops::inverse_factorial(0) == 1);
+    REQUIRE(constexpr_ops::inverse_factorial(20) == Catch::Approx(1 / 2432902008176640000.0));
+
+    for (auto x = -100.0; x <= 100.0; x += 0.37) {
+        REQUIRE(constexpr_ops::estrin<CUBIC>(x) == Catch::Approx(constexpr_ops::horner<CUBIC>(x)));
+        REQUIRE(constexpr_ops::sin(x) == Catch::Approx(std::sin(x)).margin(1e-15));
+        REQUIRE(constexpr_ops::cos(x) == Catch::Approx(std::cos(x)).margin(1e-15));
+    }
+    // Past 2^20 π / 2 the reduction switches to the three-part constant.
+    for (const auto x : {1.6e6, 1.7e6, 1e9, 1e12, -1e15, 1e15, 1e18, 0x1.fffffffffffffp61}) {
+        REQUIRE(constexpr_ops::sin(x) == Catch::Approx(std::sin(x)).margin(1e-15));
+        REQUIRE(constexpr_ops::cos(x) == Catch::Approx(std::cos(x)).margin(1e-15));
+    }
+    static_assert(constexpr_ops::sin(1e15) > 0.858 && constexpr_ops::sin(1e15) < 0.859);
+}
+
+TEST_CASE("erf and erfc", "[constexpr_ops]") {
+    static_assert(constexpr_ops::erf(0.0) == 0);
+
+    for (auto x = -30.0; x <= 30.0; x += 0.0625) {
+        REQUIRE(constexpr_ops::erf(x) == Catch::Approx(std::erf(x)).epsilon(1e-14));
+        REQUIRE(constexpr_ops::erfc(x) ==
+                Catch::Approx(std::erfc(x)).epsilon(1e-12).margin(1e-300));
+    }
+    REQUIRE(constexpr_ops::erf(1e-10) == Catch::Approx(std::erf(1e-10)).epsilon(1e-15));
+}
+
+TEST_CASE("GELU", "[gelu]") {
+    using fun::gelu_mode;
+
+    for (f32 val = RANGE_START; val <= RANGE_END; val += STEP_SIZE) {
+        for (const auto z : {static_cast<double>(val), static_cast<double>(-val)}) {
+            const auto u = std::sqrt(2 / std::numbers::pi) * (z + 0.044715 * z * z * z);
+            const auto exact = 0.5 * z * std::erfc(-z / std::sqrt(2.0));
+            const auto tanh = 0.5 * z * (1 + std::tanh(u));
+            const auto quick = z / (1 + std::exp(-1.702 * z));
+            REQUIRE(fun::gelu<gelu_mode::erf>(z) == Catch::Approx(exact).epsilon(1e-13));
+            REQUIRE(fun::gelu(z) == Catch::Approx(tanh).epsilon(1e-10).margin(1e-12));
+            REQUIRE(fun::gelu<gelu_mode::quick>(z) == Catch::Approx(quick).epsilon(1e-13));
+        }
+    }
+
+    const auto diff = [](auto f, const double z) {
+        const auto h = 1e-6;
+        return (f(z + h) - f(z - h)) / (2 * h);
+    };
+    for (auto z = -6.0; z <= 6.0; z += 0.25) {
+        REQUIRE(fun::derivative::gelu<gelu_mode::erf>(z) ==
+                Catch::Approx(diff(fun::gelu<gelu_mode::erf>, z)).margin(1e-8));
+        REQUIRE(fun::derivative::gelu<gelu_mode::tanh>(z) ==
+                Catch::Approx(diff(fun::gelu<gelu_mode::tanh>, z)).margin(1e-8));
+        REQUIRE(fun::derivative::gelu<gelu_mode::quick>(z) ==
+                Catch::Approx(diff(fun::gelu<gelu_mode::quick>, z)).margin(1e-8));
+    }
+}